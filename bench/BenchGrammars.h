@@ -0,0 +1,245 @@
+// bench/BenchGrammars.h
+// 基准测试用的合成文法
+#ifndef BENCH_GRAMMARS_H
+#define BENCH_GRAMMARS_H
+
+#include "Grammar.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+
+// 按优先级分层的表达式文法（已消除左递归，是LL(1)文法）：
+//   S' -> E0
+//   Ei  -> Ei+1 Ei'          (0 <= i < levels)
+//   Ei' -> opi Ei+1 Ei' | ε
+//   El  -> ( E0 ) | id
+// 非终结符个数为 2*levels + 2
+inline Grammar makeLayeredExpressionGrammar(int levels) {
+    // 终结符：0..levels-1为各层运算符，随后是 ( ) id $
+    int lparen = levels, rparen = levels + 1, id = levels + 2, end = levels + 3;
+    int firstNT = levels + 4;
+    auto E = [&](int i) { return firstNT + i; };
+    auto EPrime = [&](int i) { return firstNT + levels + 1 + i; };
+    int start = firstNT + 2 * levels + 1;
+
+    Grammar g;
+    g.terminal.assign(start + 1, false);
+    for (int t = 0; t <= end; t++) g.terminal[t] = true;
+    g.startSymbol = start;
+    g.endSymbol = end;
+
+    g.productions.push_back(Production(start, { E(0) }));
+    for (int i = 0; i < levels; i++) {
+        g.productions.push_back(Production(E(i), { E(i + 1), EPrime(i) }));
+        g.productions.push_back(Production(EPrime(i), { i, E(i + 1), EPrime(i) }));
+        g.productions.push_back(Production(EPrime(i), {}));
+    }
+    g.productions.push_back(Production(E(levels), { lparen, E(0), rparen }));
+    g.productions.push_back(Production(E(levels), { id }));
+    return g;
+}
+
+// 由文本规则构造文法：每条规则形如 "lhs : a b | c ;"，出现在冒号左侧的名字为
+// 非终结符，其余为终结符；第一条规则的左部作为开始符号，自动加入增广产生式
+inline Grammar makeGrammarFromRules(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream in(text);
+    std::string w;
+    while (in >> w) words.push_back(w);
+
+    std::map<std::string, bool> isNonterminal;
+    for (size_t i = 0; i + 1 < words.size(); i++) {
+        if (words[i + 1] == ":") isNonterminal[words[i]] = true;
+    }
+
+    std::map<std::string, int> ids;
+    std::vector<std::string> order;
+    auto intern = [&](const std::string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        int id = (int)order.size();
+        ids[name] = id;
+        order.push_back(name);
+        return id;
+    };
+
+    // 终结符先编号，保证ACTION列连续
+    for (const auto& word : words) {
+        if (word != ":" && word != "|" && word != ";" && !isNonterminal.count(word)) intern(word);
+    }
+    int end = intern("$");
+    int start = intern("S'");
+    for (const auto& word : words) {
+        if (isNonterminal.count(word)) intern(word);
+    }
+
+    Grammar g;
+    g.terminal.assign(order.size(), false);
+    for (int id = 0; id <= end; id++) g.terminal[id] = true;
+    g.startSymbol = start;
+    g.endSymbol = end;
+    g.productions.push_back(Production(start, {}));
+
+    int lhs = -1;
+    std::vector<int> rhs;
+    for (size_t i = 0; i < words.size(); i++) {
+        const std::string& word = words[i];
+        if (i + 1 < words.size() && words[i + 1] == ":") {
+            lhs = ids[word];
+            if (g.productions[0].rhs.empty()) g.productions[0].rhs.push_back(lhs);
+            i++;
+            rhs.clear();
+        }
+        else if (word == "|" || word == ";") {
+            g.productions.push_back(Production(lhs, rhs));
+            rhs.clear();
+        }
+        else {
+            rhs.push_back(ids[word]);
+        }
+    }
+    return g;
+}
+
+// ANSI C (C89) 文法，约210个产生式
+inline Grammar makeCGrammar() {
+    return makeGrammarFromRules(R"(
+translation_unit : external_declaration | translation_unit external_declaration ;
+external_declaration : function_definition | declaration ;
+function_definition : declaration_specifiers declarator declaration_list compound_statement
+    | declaration_specifiers declarator compound_statement
+    | declarator declaration_list compound_statement
+    | declarator compound_statement ;
+primary_expression : IDENTIFIER | CONSTANT | STRING_LITERAL | '(' expression ')' ;
+postfix_expression : primary_expression
+    | postfix_expression '[' expression ']'
+    | postfix_expression '(' ')'
+    | postfix_expression '(' argument_expression_list ')'
+    | postfix_expression '.' IDENTIFIER
+    | postfix_expression PTR_OP IDENTIFIER
+    | postfix_expression INC_OP
+    | postfix_expression DEC_OP ;
+argument_expression_list : assignment_expression | argument_expression_list ',' assignment_expression ;
+unary_expression : postfix_expression
+    | INC_OP unary_expression
+    | DEC_OP unary_expression
+    | unary_operator cast_expression
+    | SIZEOF unary_expression
+    | SIZEOF '(' type_name ')' ;
+unary_operator : '&' | '*' | '+' | '-' | '~' | '!' ;
+cast_expression : unary_expression | '(' type_name ')' cast_expression ;
+multiplicative_expression : cast_expression
+    | multiplicative_expression '*' cast_expression
+    | multiplicative_expression '/' cast_expression
+    | multiplicative_expression '%' cast_expression ;
+additive_expression : multiplicative_expression
+    | additive_expression '+' multiplicative_expression
+    | additive_expression '-' multiplicative_expression ;
+shift_expression : additive_expression
+    | shift_expression LEFT_OP additive_expression
+    | shift_expression RIGHT_OP additive_expression ;
+relational_expression : shift_expression
+    | relational_expression '<' shift_expression
+    | relational_expression '>' shift_expression
+    | relational_expression LE_OP shift_expression
+    | relational_expression GE_OP shift_expression ;
+equality_expression : relational_expression
+    | equality_expression EQ_OP relational_expression
+    | equality_expression NE_OP relational_expression ;
+and_expression : equality_expression | and_expression '&' equality_expression ;
+exclusive_or_expression : and_expression | exclusive_or_expression '^' and_expression ;
+inclusive_or_expression : exclusive_or_expression | inclusive_or_expression '|' exclusive_or_expression ;
+logical_and_expression : inclusive_or_expression | logical_and_expression AND_OP inclusive_or_expression ;
+logical_or_expression : logical_and_expression | logical_or_expression OR_OP logical_and_expression ;
+conditional_expression : logical_or_expression
+    | logical_or_expression '?' expression ':' conditional_expression ;
+assignment_expression : conditional_expression
+    | unary_expression assignment_operator assignment_expression ;
+assignment_operator : '=' | MUL_ASSIGN | DIV_ASSIGN | MOD_ASSIGN | ADD_ASSIGN | SUB_ASSIGN
+    | LEFT_ASSIGN | RIGHT_ASSIGN | AND_ASSIGN | XOR_ASSIGN | OR_ASSIGN ;
+expression : assignment_expression | expression ',' assignment_expression ;
+constant_expression : conditional_expression ;
+declaration : declaration_specifiers ';' | declaration_specifiers init_declarator_list ';' ;
+declaration_specifiers : storage_class_specifier
+    | storage_class_specifier declaration_specifiers
+    | type_specifier
+    | type_specifier declaration_specifiers
+    | type_qualifier
+    | type_qualifier declaration_specifiers ;
+init_declarator_list : init_declarator | init_declarator_list ',' init_declarator ;
+init_declarator : declarator | declarator '=' initializer ;
+storage_class_specifier : TYPEDEF | EXTERN | STATIC | AUTO | REGISTER ;
+type_specifier : VOID | CHAR | SHORT | INT | LONG | FLOAT | DOUBLE | SIGNED | UNSIGNED
+    | struct_or_union_specifier | enum_specifier | TYPE_NAME ;
+struct_or_union_specifier : struct_or_union IDENTIFIER '{' struct_declaration_list '}'
+    | struct_or_union '{' struct_declaration_list '}'
+    | struct_or_union IDENTIFIER ;
+struct_or_union : STRUCT | UNION ;
+struct_declaration_list : struct_declaration | struct_declaration_list struct_declaration ;
+struct_declaration : specifier_qualifier_list struct_declarator_list ';' ;
+specifier_qualifier_list : type_specifier specifier_qualifier_list
+    | type_specifier
+    | type_qualifier specifier_qualifier_list
+    | type_qualifier ;
+struct_declarator_list : struct_declarator | struct_declarator_list ',' struct_declarator ;
+struct_declarator : declarator | ':' constant_expression | declarator ':' constant_expression ;
+enum_specifier : ENUM '{' enumerator_list '}'
+    | ENUM IDENTIFIER '{' enumerator_list '}'
+    | ENUM IDENTIFIER ;
+enumerator_list : enumerator | enumerator_list ',' enumerator ;
+enumerator : IDENTIFIER | IDENTIFIER '=' constant_expression ;
+type_qualifier : CONST | VOLATILE ;
+declarator : pointer direct_declarator | direct_declarator ;
+direct_declarator : IDENTIFIER
+    | '(' declarator ')'
+    | direct_declarator '[' constant_expression ']'
+    | direct_declarator '[' ']'
+    | direct_declarator '(' parameter_type_list ')'
+    | direct_declarator '(' identifier_list ')'
+    | direct_declarator '(' ')' ;
+pointer : '*' | '*' type_qualifier_list | '*' pointer | '*' type_qualifier_list pointer ;
+type_qualifier_list : type_qualifier | type_qualifier_list type_qualifier ;
+parameter_type_list : parameter_list | parameter_list ',' ELLIPSIS ;
+parameter_list : parameter_declaration | parameter_list ',' parameter_declaration ;
+parameter_declaration : declaration_specifiers declarator
+    | declaration_specifiers abstract_declarator
+    | declaration_specifiers ;
+identifier_list : IDENTIFIER | identifier_list ',' IDENTIFIER ;
+type_name : specifier_qualifier_list | specifier_qualifier_list abstract_declarator ;
+abstract_declarator : pointer | direct_abstract_declarator | pointer direct_abstract_declarator ;
+direct_abstract_declarator : '(' abstract_declarator ')'
+    | '[' ']'
+    | '[' constant_expression ']'
+    | direct_abstract_declarator '[' ']'
+    | direct_abstract_declarator '[' constant_expression ']'
+    | '(' ')'
+    | '(' parameter_type_list ')'
+    | direct_abstract_declarator '(' ')'
+    | direct_abstract_declarator '(' parameter_type_list ')' ;
+initializer : assignment_expression | '{' initializer_list '}' | '{' initializer_list ',' '}' ;
+initializer_list : initializer | initializer_list ',' initializer ;
+statement : labeled_statement | compound_statement | expression_statement
+    | selection_statement | iteration_statement | jump_statement ;
+labeled_statement : IDENTIFIER ':' statement
+    | CASE constant_expression ':' statement
+    | DEFAULT ':' statement ;
+compound_statement : '{' '}'
+    | '{' statement_list '}'
+    | '{' declaration_list '}'
+    | '{' declaration_list statement_list '}' ;
+declaration_list : declaration | declaration_list declaration ;
+statement_list : statement | statement_list statement ;
+expression_statement : ';' | expression ';' ;
+selection_statement : IF '(' expression ')' statement
+    | IF '(' expression ')' statement ELSE statement
+    | SWITCH '(' expression ')' statement ;
+iteration_statement : WHILE '(' expression ')' statement
+    | DO statement WHILE '(' expression ')' ';'
+    | FOR '(' expression_statement expression_statement ')' statement
+    | FOR '(' expression_statement expression_statement expression ')' statement ;
+jump_statement : GOTO IDENTIFIER ';' | CONTINUE ';' | BREAK ';' | RETURN ';' | RETURN expression ';' ;
+)");
+}
+
+#endif // BENCH_GRAMMARS_H
@@ -0,0 +1,31 @@
+// bench/BenchPrograms.h
+// 基准测试用的程序生成器
+#ifndef BENCH_PROGRAMS_H
+#define BENCH_PROGRAMS_H
+
+#include <string>
+
+// 生成约tokenCount个记号的合法程序，返回实际记号数
+inline size_t generateProgram(size_t tokenCount, std::string& prog) {
+    static const char* const templates[] = {
+        "ID = ID + NUM * ( ID - NUM ) ;\n",                          // 12
+        "while ( ID < NUM ) { ID = ID / NUM ; }\n",                  // 14
+        "if ( ID == NUM ) then ID = NUM ; else ID = ID - NUM ;\n",   // 16
+    };
+    static const size_t templateTokens[] = { 12, 14, 16 };
+
+    prog.clear();
+    prog.reserve(tokenCount * 4);
+    prog += "{\n";
+    size_t count = 2;
+    size_t i = 0;
+    while (count < tokenCount) {
+        prog += templates[i % 3];
+        count += templateTokens[i % 3];
+        i++;
+    }
+    prog += "}\n";
+    return count;
+}
+
+#endif // BENCH_PROGRAMS_H
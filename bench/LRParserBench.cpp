@@ -0,0 +1,97 @@
+// bench/LRParserBench.cpp
+// SLR语法分析吞吐量基准：生成 10^3 ~ 10^N 个记号的程序并计时解析
+#include "BenchPrograms.h"
+#include "LRParser.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// 分析表构造与缓存加载的耗时对比
+static void benchTableCache(const string& cachePath) {
+    remove(cachePath.c_str());
+
+    auto t0 = chrono::steady_clock::now();
+    SLRTables::create();
+    auto t1 = chrono::steady_clock::now();
+    SLRTables::create(cachePath);
+    auto t2 = chrono::steady_clock::now();
+    shared_ptr<const SLRTables> loaded = SLRTables::create(cachePath);
+    auto t3 = chrono::steady_clock::now();
+
+    printf("table build: %.1f us, build+save: %.1f us, cache load: %.1f us (%s)\n\n",
+           chrono::duration<double, micro>(t1 - t0).count(),
+           chrono::duration<double, micro>(t2 - t1).count(),
+           chrono::duration<double, micro>(t3 - t2).count(),
+           loaded->loadedFromCache() ? "hit" : "miss");
+    remove(cachePath.c_str());
+}
+
+// 多线程共享同一份分析表：每个线程一个SLRParser，各自解析相同的程序
+static void benchConcurrent(unsigned maxThreads) {
+    string prog;
+    size_t tokens = generateProgram(100000, prog);
+    shared_ptr<const SLRTables> tables = SLRTables::shared();
+    const int rounds = 8;
+
+    printf("%8s %12s %12s %s\n", "threads", "ms", "Mtok/s", "result");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        atomic<int> failures(0);
+        auto start = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (unsigned t = 0; t < threads; t++) {
+            pool.emplace_back([&]() {
+                SLRParser parser(tables);
+                parser.setRecordDerivation(false);
+                parser.setBuildTree(false);
+                for (int r = 0; r < rounds; r++) {
+                    if (!parser.parse(prog)) failures++;
+                }
+            });
+        }
+        for (auto& th : pool) th.join();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        printf("%8u %12.2f %12.2f %s\n", threads, ms, tokens * rounds * threads / ms / 1000.0,
+               failures ? "FAILED" : "ok");
+    }
+    printf("\n");
+}
+
+// 用法: lr_bench [最大指数, 默认7] [缓存文件路径] [最大线程数, 默认为硬件线程数]
+int main(int argc, char* argv[]) {
+    int maxExponent = argc > 1 ? atoi(argv[1]) : 7;
+    if (maxExponent < 3) maxExponent = 3;
+    unsigned maxThreads = argc > 3 ? (unsigned)atoi(argv[3]) : thread::hardware_concurrency();
+    if (maxThreads < 1) maxThreads = 1;
+
+    benchTableCache(argc > 2 ? argv[2] : "lr_bench_tables.bin");
+    benchConcurrent(maxThreads);
+
+    SLRParser parser;
+    parser.setRecordDerivation(false);
+    parser.setBuildTree(false);
+
+    printf("%12s %12s %10s %12s %s\n", "tokens", "bytes", "ms", "Mtok/s", "result");
+
+    string prog;
+    size_t target = 1000;
+    for (int e = 3; e <= maxExponent; e++, target *= 10) {
+        size_t tokens = generateProgram(target, prog);
+
+        auto start = chrono::steady_clock::now();
+        bool ok = parser.parse(prog);
+        auto end = chrono::steady_clock::now();
+
+        double ms = chrono::duration<double, milli>(end - start).count();
+        double rate = ms > 0 ? tokens / ms / 1000.0 : 0.0;
+        printf("%12zu %12zu %10.2f %12.2f %s\n", tokens, prog.size(), ms, rate, ok ? "ok" : "FAILED");
+    }
+    return 0;
+}
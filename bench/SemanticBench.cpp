@@ -0,0 +1,196 @@
+// bench/SemanticBench.cpp
+// 语义分析执行引擎对比：逐记号解释、未优化与优化后的字节码虚拟机、JIT
+#include "Semantic.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 循环n次的算术密集程序
+static string loopProgram(long n) {
+    return "int a = 0 ; int b = 0 ; real c = 0.5 ;\n"
+           "{\n"
+           "while ( a < " + to_string(n) + " ) {\n"
+           "a = a + 1 ;\n"
+           "b = ( b + a * 3 - a / 7 ) / 2 ;\n"
+           "if ( b > a ) then c = c + 1.5 ; else c = c - 0.25 ;\n"
+           "}\n"
+           "}\n";
+}
+
+// n条顺序执行的赋值语句
+static string straightProgram(long n) {
+    string prog = "int a = 1 ; int b = 2 ; real c = 3.0 ;\n{\n";
+    for (long i = 0; i < n; i++) {
+        prog += "a = a + b * 2 - 1 ; b = b - a / 3 ; c = c * 1.0001 + ( a - b ) ;\n";
+    }
+    prog += "}\n";
+    return prog;
+}
+
+// 循环1000次，每轮只走then分支；else分支是n层嵌套的条件语句，从不执行
+static string deadBranchProgram(long n) {
+    string prog = "int a = 0 ; int b = 0 ; real c = 0.5 ;\n"
+                  "{\n"
+                  "while ( a < 1000 ) {\n"
+                  "a = a + 1 ;\n"
+                  "if ( a > 0 ) then b = b + 1 ; else\n";
+    for (long i = 0; i < n; i++) {
+        prog += "if ( b < a * 2 ) then { c = c * 2.0 + a / 3 ; b = b - 1 ; } else\n";
+    }
+    prog += "c = c + 1.0 ;\n}\n}\n";
+    return prog;
+}
+
+// 批量执行用的小程序：初始值由各行给出
+static string batchProgram(int64_t a, int64_t b, double c) {
+    char header[160];
+    snprintf(header, sizeof(header), "int a = %lld ; int b = %lld ; real c = %.1f ;\n", (long long)a, (long long)b, c);
+    return string(header) +
+           "{\n"
+           "if ( a > b ) then { c = c * 2.0 + a ; b = b + a / 3 ; } else { c = c - 0.5 ; a = a * 3 - b ; }\n"
+           "b = b * 7 - a ;\n"
+           "if ( c >= 10.0 ) then a = a + 1 ; else a = a - 1 ;\n"
+           "}\n";
+}
+
+// 同一程序对rows组初始值执行：逐行analyze与analyzeBatch对比
+static void compareBatch(size_t rows) {
+    SemBatchTable table;
+    table.rows = rows;
+    SemColumn a, b, c;
+    a.name = "a";
+    b.name = "b";
+    c.name = "c";
+    c.type = SEM_REAL;
+    for (size_t r = 0; r < rows; r++) {
+        a.ints.push_back((int64_t)(r % 97));
+        b.ints.push_back((int64_t)(r % 89));
+        c.reals.push_back((double)(r % 13) + 0.5);
+    }
+    table.columns = { a, b, c };
+
+    auto start = chrono::steady_clock::now();
+    vector<int64_t> expected(rows);
+    for (size_t r = 0; r < rows; r++) {
+        SemanticAnalyzer analyzer;
+        analyzer.analyze(batchProgram(a.ints[r], b.ints[r], c.reals[r]));
+        expected[r] = analyzer.symbols().at("b").i;
+    }
+    double rowMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    SemanticAnalyzer analyzer;
+    SemBatchResult result;
+    string failure;
+    bool ok = analyzer.analyzeBatch(batchProgram(0, 0, 0.0), table, result, failure);
+    double batchMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    ok = ok && result.find("b")->ints == expected;
+
+    char name[64];
+    snprintf(name, sizeof(name), "batch rows %zu", rows);
+    printf("%-28s %12.2f %12.2f %10.1fx %s\n", name, rowMs, batchMs, batchMs > 0 ? rowMs / batchMs : 0.0,
+           ok ? "identical" : "MISMATCH");
+}
+
+static double run(const string& prog, bool bytecode, bool optimize, SemanticAnalyzer& analyzer, bool jit = false) {
+    analyzer.setUseBytecode(bytecode);
+    analyzer.setOptimize(optimize);
+    analyzer.setUseJit(jit);
+    // 不限嵌套深度，dead-branch的深层嵌套也照常执行
+    SemBudget unlimited;
+    unlimited.maxDepth = 0;
+    analyzer.setBudget(unlimited);
+    auto start = chrono::steady_clock::now();
+    analyzer.analyze(prog);
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static bool sameSymbols(const SemanticAnalyzer& a, const SemanticAnalyzer& b) {
+    const SymbolTable& x = a.symbols();
+    const SymbolTable& y = b.symbols();
+    if (x.size() != y.size()) return false;
+    for (int s = 0; s < x.size(); s++) {
+        if (x.name(s) != y.name(s) || x[s].type != y[s].type || x[s].number() != y[s].number()) return false;
+    }
+    return true;
+}
+
+static void compare(const char* name, const string& prog) {
+    SemanticAnalyzer walker, vm, opt, jit;
+    double walkMs = run(prog, false, false, walker);
+    double vmMs = run(prog, true, false, vm);
+    double optMs = run(prog, true, true, opt);
+    double jitMs = run(prog, true, true, jit, true);
+    bool same = sameSymbols(walker, vm) && walker.errorMessages() == vm.errorMessages() &&
+                sameSymbols(walker, opt) && walker.errorMessages() == opt.errorMessages() &&
+                sameSymbols(walker, jit) && walker.errorMessages() == jit.errorMessages();
+    // JIT的编译与执行分开计时（微秒），不含前端与优化
+    const SemJitStats& js = jit.jitStats();
+    printf("%-28s %12.2f %12.2f %12.2f %12.2f %10.1f %10.1f %s\n", name, walkMs, vmMs, optMs, jitMs,
+           js.compileMicros, js.executeMicros, same ? "identical" : "MISMATCH");
+}
+
+// 语句级剖析的开销：剖析时逐条语句计时，对比关闭剖析的逐记号解释
+static void compareProfile(const char* name, const string& prog) {
+    SemanticAnalyzer plain, profiled;
+    double plainMs = run(prog, false, false, plain);
+    profiled.setProfiling(true);
+    double profiledMs = run(prog, false, false, profiled);
+    bool same = sameSymbols(plain, profiled) && plain.errorMessages() == profiled.errorMessages();
+    printf("%-28s %12.2f %12.2f %10.2fx %s\n", name, plainMs, profiledMs, plainMs > 0 ? profiledMs / plainMs : 0.0,
+           same ? "identical" : "MISMATCH");
+}
+
+// 用法: semantic_bench [循环次数上限的指数, 默认6]
+int main(int argc, char* argv[]) {
+    int maxExponent = argc > 1 ? atoi(argv[1]) : 6;
+    if (maxExponent < 2) maxExponent = 2;
+
+    printf("%-28s %12s %12s %12s %12s %10s %10s %s\n", "program", "walk ms", "vm -O0 ms", "vm -O ms", "jit -O ms",
+           "jit cc us", "jit run us", "check");
+    long n = 100;
+    for (int e = 2; e <= maxExponent; e++, n *= 10) {
+        char name[64];
+        snprintf(name, sizeof(name), "while x%ld", n);
+        compare(name, loopProgram(n));
+    }
+    n = 100;
+    for (int e = 2; e <= maxExponent - 1; e++, n *= 10) {
+        char name[64];
+        snprintf(name, sizeof(name), "straight-line x%ld", n);
+        compare(name, straightProgram(n));
+    }
+    // 执行路径固定，不执行的分支越来越深：解释时间应只随执行路径变化
+    n = 10;
+    for (int e = 1; e <= maxExponent - 2; e++, n *= 10) {
+        char name[64];
+        snprintf(name, sizeof(name), "dead-branch depth %ld", n);
+        compare(name, deadBranchProgram(n));
+    }
+
+    // 批量执行：SIMD逐行向量化对比逐行analyze
+    printf("\n%-28s %12s %12s %11s %s\n", "program", "per-row ms", "batch ms", "speedup", "check");
+    size_t rows = 100;
+    for (int e = 2; e <= maxExponent - 1; e++, rows *= 10) compareBatch(rows);
+
+    printf("\n%-28s %12s %12s %11s %s\n", "program", "walk ms", "profile ms", "overhead", "check");
+    n = 100;
+    for (int e = 2; e <= maxExponent - 1; e++, n *= 10) {
+        char name[64];
+        snprintf(name, sizeof(name), "while x%ld", n);
+        compareProfile(name, loopProgram(n));
+    }
+
+    // 各优化遍的耗时与改写次数
+    SemanticAnalyzer analyzer;
+    printf("\noptimization passes on straight-line x1000:\n");
+    analyzer.analyze(straightProgram(1000));
+    analyzer.optimizationReport().print(cout);
+    return 0;
+}
@@ -0,0 +1,174 @@
+// bench/ServerBench.cpp
+// 常驻服务的单请求延迟：每次新建分析状态（相当于每个输入启动一次进程）、
+// 进程内复用AnalysisSession、经Unix域套接字请求常驻服务三者对比
+#include "Driver.h"
+#include "Server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char* const semProgram =
+    "int a = 1 ; int b = 2 ; real c = 3.0 ;\n"
+    "{\n"
+    "  a = a + 1 ;\n"
+    "  b = b * a ;\n"
+    "  if ( a < b ) then c = c / 2 ; else c = c * 2 ;\n"
+    "  while ( a < 10 ) a = a + 1 ;\n"
+    "}\n";
+
+static const char* const slrProgram =
+    "{\n"
+    "  while ( ID < NUM ) { ID = ID / NUM ; }\n"
+    "  if ( ID == NUM ) then ID = NUM ; else ID = ID - NUM ;\n"
+    "}\n";
+
+static double sinceMicros(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+}
+
+struct Latency {
+    double mean, p50, p99;
+};
+
+static Latency summarize(vector<double>& samples) {
+    sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double s : samples) sum += s;
+    return {sum / samples.size(), samples[samples.size() / 2], samples[samples.size() * 99 / 100]};
+}
+
+static void report(const char* name, vector<double>& samples) {
+    Latency l = summarize(samples);
+    printf("%-34s %10.1f %10.1f %10.1f\n", name, l.mean, l.p50, l.p99);
+}
+
+// 每个请求新建分析表与分析器，近似每次启动进程的初始化开销（不含进程创建本身）
+static void coldRequests(DriverMode mode, const string& code, int n, const char* name) {
+    vector<double> samples;
+    DriverOptions options;
+    for (int i = 0; i < n; i++) {
+        auto start = chrono::steady_clock::now();
+        AnalysisSession session(options, mode == DRIVER_SLR ? SLRTables::create() : nullptr);
+        string detail;
+        session.process(mode, code, FORMAT_SUMMARY, cout, detail);
+        samples.push_back(sinceMicros(start));
+    }
+    report(name, samples);
+}
+
+static void warmRequests(DriverMode mode, const string& code, int n, const char* name) {
+    vector<double> samples;
+    DriverOptions options;
+    AnalysisSession session(options);
+    string detail;
+    session.process(mode, code, FORMAT_SUMMARY, cout, detail);
+    for (int i = 0; i < n; i++) {
+        auto start = chrono::steady_clock::now();
+        session.process(mode, code, FORMAT_SUMMARY, cout, detail);
+        samples.push_back(sinceMicros(start));
+    }
+    report(name, samples);
+}
+
+#ifndef _WIN32
+static int connectTo(const string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+    if (fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) return fd;
+    if (fd >= 0) close(fd);
+    return -1;
+}
+
+static bool roundTrip(int fd, const string& request, string& response) {
+    return writeServerFrame(fd, request) && readServerFrame(fd, response);
+}
+
+static void serverRequests(const string& path, DriverMode mode, const string& code, int n, const char* name) {
+    int fd = connectTo(path);
+    if (fd < 0) {
+        printf("%-34s 无法连接\n", name);
+        return;
+    }
+    string request = makeServerRequest(mode, FORMAT_SUMMARY, code), response;
+    roundTrip(fd, request, response);
+    vector<double> samples;
+    for (int i = 0; i < n; i++) {
+        auto start = chrono::steady_clock::now();
+        if (!roundTrip(fd, request, response)) break;
+        samples.push_back(sinceMicros(start));
+    }
+    close(fd);
+    if (!samples.empty()) report(name, samples);
+}
+
+// clients个连接同时发送请求的总吞吐量
+static void serverThroughput(const string& path, const string& code, int clients, int perClient) {
+    string request = makeServerRequest(DRIVER_SEM, FORMAT_SUMMARY, code);
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&] {
+            int fd = connectTo(path);
+            if (fd < 0) return;
+            string response;
+            for (int i = 0; i < perClient; i++) {
+                if (!roundTrip(fd, request, response)) break;
+            }
+            close(fd);
+        });
+    }
+    for (thread& t : threads) t.join();
+    double seconds = sinceMicros(start) / 1e6;
+    printf("%-34s %10d %10.0f\n", ("sem, " + to_string(clients) + " clients").c_str(), clients * perClient,
+           clients * perClient / seconds);
+}
+#endif
+
+// 用法: server_bench [每种情况的请求数, 默认2000]
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 2000;
+    if (n < 10) n = 10;
+
+    printf("%-34s %10s %10s %10s\n", "per-request latency", "mean us", "p50 us", "p99 us");
+    coldRequests(DRIVER_SLR, slrProgram, max(10, n / 100), "slr, new tables per request");
+    warmRequests(DRIVER_SLR, slrProgram, n, "slr, warm session");
+    coldRequests(DRIVER_SEM, semProgram, n, "sem, new analyzer per request");
+    warmRequests(DRIVER_SEM, semProgram, n, "sem, warm session");
+
+#ifndef _WIN32
+    DriverOptions options;
+    unsigned threads = max(2u, thread::hardware_concurrency());
+    AnalysisServer server(options, threads);
+    string path = "/tmp/server_bench_" + to_string(getpid()) + ".sock";
+    string failure;
+    if (!server.listen(path, failure)) {
+        printf("%s\n", failure.c_str());
+        return 1;
+    }
+    thread serving([&] { server.serve(); });
+    serverRequests(path, DRIVER_SLR, slrProgram, n, "slr, unix socket");
+    serverRequests(path, DRIVER_SEM, semProgram, n, "sem, unix socket");
+
+    printf("\n%-34s %10s %10s\n", "concurrent clients", "requests", "req/s");
+    for (int clients = 1; clients <= (int)threads; clients *= 2) serverThroughput(path, semProgram, clients, n);
+    server.stop();
+    serving.join();
+#endif
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Driver.h
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "LRParser.h"
+#include "SLRPipeline.h"
+#include "Semantic.h"
+
+// 功能编号与交互模式的菜单相同
+enum DriverMode {
+    DRIVER_LEX = 1,     // 词法分析
+    DRIVER_LL1,         // LL(1)语法分析
+    DRIVER_SLR,         // SLR语法分析
+    DRIVER_SEM          // 语义分析
+};
+
+enum DriverFormat {
+    FORMAT_TEXT,        // 与交互模式相同的完整输出
+    FORMAT_SUMMARY,     // 每个输入一行：路径、功能、ok/error与简要结果，以制表符分隔
+    FORMAT_NDJSON       // 每行一条JSON记录（记录类别与写出时机见OutputSink.h）；
+                        // 每个输入以file记录开始、result记录结束
+};
+
+enum DriverSlrEngine {
+    SLR_ENGINE_TABLE,   // 表驱动分析器，带错误恢复（默认）
+    SLR_ENGINE_DIRECT   // 构建时生成的直接编码分析器，只做识别，用于摘要格式（见SLRDirect.h）
+};
+
+enum DriverEngine {
+    ENGINE_WALK,        // 逐记号解释
+    ENGINE_VM,          // 字节码虚拟机（默认）
+    ENGINE_JIT          // 本机代码，平台不支持时退回虚拟机
+};
+
+// 服务模式下未给出--max-millis、--max-memory时每个请求的语义分析预算，
+// 避免一个请求长期占住工作线程或耗尽进程的内存
+const double SERVER_DEFAULT_MILLIS = 10000;
+const uint64_t SERVER_DEFAULT_MEMORY = 256u << 20;
+
+// 命令行选项
+struct DriverOptions {
+    DriverMode mode = DRIVER_SEM;
+    bool modeGiven = false;
+    std::vector<std::string> inputs;    // 输入文件或目录（递归处理其中的文件），"-"为标准输入
+    DriverFormat format = FORMAT_TEXT;
+    std::string outputPath;             // 非空时结果写入该文件而不是标准输出
+    bool stats = false;                 // 在标准错误输出每个输入的耗时与汇总
+    bool help = false;
+    unsigned jobs = 1;                  // 并行处理输入的线程数，0为硬件线程数
+    std::string tableCache;             // SLR分析表缓存文件
+    DriverSlrEngine slrEngine = SLR_ENGINE_TABLE;
+    bool pipeline = false;              // SLR分析时词法、语法与输出分别在各自的线程上流水执行（见SLRPipeline.h）
+    DriverEngine engine = ENGINE_VM;
+    bool optimize = true;
+    bool profile = false;               // 语义分析时在标准错误输出热点表
+    uint64_t maxSteps = 0;              // 语义分析的执行预算，0为不限
+    double maxMillis = 0;
+    uint64_t maxMemory = 0;             // 字节
+    std::string serveSocket;            // 非空时作为常驻服务在该Unix域套接字上监听（见Server.h）
+    bool serveStdio = false;            // 作为常驻服务从标准输入读请求、向标准输出写响应
+    unsigned threads = 0;               // 服务的工作线程数，0为硬件线程数
+
+    bool serving() const { return serveStdio || !serveSocket.empty(); }
+};
+
+// 一个线程上的分析状态：SLR分析表与语义分析器只建立一次，供多个输入复用。
+// 各功能的输出写入调用方给出的流而不是std::cout，因此每个线程各用一个会话即可并发处理。
+class AnalysisSession {
+public:
+    // tables为空时在首次SLR分析时取进程内共享的分析表（或按options.tableCache加载）
+    explicit AnalysisSession(const DriverOptions& options,
+                             std::shared_ptr<const SLRTables> tables = std::shared_ptr<const SLRTables>());
+
+    // 分析一个输入，按format把与交互模式相同的文本或NDJSON记录写入out，摘要格式时不写；
+    // 返回是否没有词法/语法/语义错误，detail为摘要格式的简要结果
+    bool process(DriverMode mode, const std::string& code, DriverFormat format, std::ostream& out,
+                 std::string& detail);
+
+    // 最近一次语义分析的分析器（剖析结果等）
+    const SemanticAnalyzer& semantic() const { return analyzer; }
+    // 最近一次流水线SLR分析的各阶段耗时
+    const SLRPipelineStats& pipelineStats() const { return lastPipeline; }
+
+private:
+    const DriverOptions& options;
+    std::shared_ptr<const SLRTables> tables;
+    SemanticAnalyzer analyzer;
+    SLRPipelineStats lastPipeline;
+
+    bool lex(const std::string& code, DriverFormat format, std::ostream& out, std::string& detail);
+    bool ll1(const std::string& code, DriverFormat format, std::ostream& out, std::string& detail);
+    bool slr(const std::string& code, DriverFormat format, std::ostream& out, std::string& detail);
+    bool sem(const std::string& code, DriverFormat format, std::ostream& out, std::string& detail);
+};
+
+const char* driverModeName(DriverMode mode);
+
+// 解析命令行；参数有误时返回false并在failure中说明原因
+bool parseDriverArgs(int argc, char* argv[], DriverOptions& options, std::string& failure);
+void printDriverUsage(std::ostream& out);
+
+// 在一个进程内处理全部输入，返回进程退出码：
+// 0全部通过，1有输入存在词法/语法/语义错误，2有输入无法读取。
+// jobs大于1时由工作窃取的线程池并行处理，每个线程一个AnalysisSession；
+// 各输入的输出先写入缓冲区，仍按输入顺序输出。
+int runDriver(const DriverOptions& options);
+
+#endif // DRIVER_H
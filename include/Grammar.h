@@ -0,0 +1,131 @@
+// Grammar.h
+#ifndef GRAMMAR_H
+#define GRAMMAR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// 最低位1的位置（w != 0）
+inline int lowestSetBit(uint64_t w) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, w);
+    return (int)index;
+#else
+    return __builtin_ctzll(w);
+#endif
+}
+
+// 产生式结构
+struct Production {
+    int lhs;
+    std::vector<int> rhs;
+    Production(int l = 0, std::vector<int> r = {}) : lhs(l), rhs(r) {}
+};
+
+// 以符号编号为下标的稠密位集合
+class SymbolSet {
+public:
+    explicit SymbolSet(int symbolCount = 0) : words((symbolCount + 63) / 64, 0) {}
+
+    bool test(int sym) const { return (words[sym >> 6] >> (sym & 63)) & 1; }
+
+    // 返回集合是否发生变化
+    bool insert(int sym) {
+        uint64_t bit = uint64_t(1) << (sym & 63);
+        if (words[sym >> 6] & bit) return false;
+        words[sym >> 6] |= bit;
+        return true;
+    }
+
+    bool unionWith(const SymbolSet& other) {
+        uint64_t changed = 0;
+        for (size_t i = 0; i < words.size(); i++) {
+            uint64_t merged = words[i] | other.words[i];
+            changed |= merged ^ words[i];
+            words[i] = merged;
+        }
+        return changed != 0;
+    }
+
+    template<typename F>
+    void forEach(F f) const {
+        for (size_t i = 0; i < words.size(); i++) {
+            uint64_t w = words[i];
+            while (w) {
+                int bit = lowestSetBit(w);
+                f(int(i * 64 + bit));
+                w &= w - 1;
+            }
+        }
+    }
+
+    void clear() {
+        for (uint64_t& w : words) w = 0;
+    }
+
+    bool empty() const {
+        for (uint64_t w : words) if (w) return false;
+        return true;
+    }
+
+private:
+    std::vector<uint64_t> words;
+};
+
+// 文法描述：符号编号取值于 [0, symbolCount)，允许存在未使用的编号
+struct Grammar {
+    std::vector<Production> productions;
+    std::vector<bool> terminal;     // terminal[sym]为真表示终结符
+    int startSymbol = 0;            // 增广开始符号
+    int endSymbol = 0;              // 输入结束符 $
+
+    int symbolCount() const { return (int)terminal.size(); }
+    bool isTerminal(int sym) const { return terminal[sym]; }
+};
+
+// FIRST/FOLLOW集计算
+// 空串不再用哨兵-1表示，而是单独的nullable标记；集合为位集合。
+// 可空性用工作表求出；FIRST/FOLLOW先建立包含关系的依赖图，再按强连通分量
+// 的拓扑序一次传播完成，而不是反复扫描全部产生式直到不动点。
+class GrammarSets {
+public:
+    explicit GrammarSets(const Grammar& grammar);
+
+    bool nullable(int sym) const { return nullableSet.test(sym); }
+    const SymbolSet& first(int sym) const { return firstSets[sym]; }
+    const SymbolSet& follow(int sym) const { return followSets[sym]; }
+
+    // 计算符号串的FIRST集并入out，返回该符号串能否推出空串
+    bool firstOfSequence(const std::vector<int>& seq, size_t from, SymbolSet& out) const;
+
+private:
+    void computeNullable(const Grammar& grammar);
+    void computeFirst(const Grammar& grammar);
+    void computeFollow(const Grammar& grammar);
+    // 沿依赖边 sets[from] ⊆ sets[to] 传播到不动点
+    static void propagate(std::vector<SymbolSet>& sets,
+                          const std::vector<std::vector<int>>& successors);
+
+    SymbolSet nullableSet;
+    std::vector<SymbolSet> firstSets;
+    std::vector<SymbolSet> followSets;
+};
+
+// LL(1)预测分析表：entry(A, a) 为产生式编号，-1表示出错
+struct LL1Table {
+    int symbolCount = 0;
+    std::vector<int> entries;
+    std::vector<std::string> conflicts;   // 每条冲突的描述
+
+    int entry(int nonterminal, int terminal) const { return entries[nonterminal * symbolCount + terminal]; }
+};
+
+LL1Table buildLL1Table(const Grammar& grammar, const GrammarSets& sets);
+
+#endif // GRAMMAR_H
@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <iosfwd>
+#include "OutputSink.h"
 
 // Token类型枚举
 namespace MyLL1 {
@@ -86,9 +88,12 @@ private:
     bool hasError;
     int tokenIndex;
     bool flag;
+    std::ostream* out;      // 错误信息与语法树的输出位置，默认为std::cout
+    ReportFormat format;    // 错误信息按文本还是diagnostic记录输出
     
     // 打印语法树的辅助函数
-    void printTree(TreeNode* node, int depth);
+    void printTree(OutputSink& sink, TreeNode* node, int depth);
+    void writeNode(OutputSink& sink, TreeNode* node, int parent, int depth, int& nextId);
     
     // 错误恢复
     void errorRecovery(const std::string& message);
@@ -127,6 +132,11 @@ public:
     
     bool parse(const std::string& input);
     void printSyntaxTree();
+    // 改变输出位置；每个线程各用一个Parser并各自指定输出时可并发使用
+    void setOutput(std::ostream& os) { out = &os; }
+    void setReportFormat(ReportFormat f) { format = f; }
+    // 语法树按先序每个结点一条node记录，根结点的parent为-1
+    void writeTreeNdjson();
     
     // 提供给外部调用的接口
     void Analysis(const std::string& prog);
@@ -0,0 +1,66 @@
+// LRAutomaton.h
+#ifndef LRAUTOMATON_H
+#define LRAUTOMATON_H
+
+#include <utility>
+#include <vector>
+#include "Grammar.h"
+
+// LR项结构
+struct LR_item {
+    int productionId;
+    int dotPos;
+
+    LR_item(int pid = 0, int pos = 0) : productionId(pid), dotPos(pos) {}
+
+    bool operator<(const LR_item& other) const {
+        if (productionId != other.productionId)
+            return productionId < other.productionId;
+        return dotPos < other.dotPos;
+    }
+
+    bool operator==(const LR_item& other) const {
+        return productionId == other.productionId && dotPos == other.dotPos;
+    }
+};
+
+// 稠密ACTION表项编码：低2位为动作类型，其余位为目标状态或产生式编号
+enum ActionKind {
+    ACT_ERROR = 0,
+    ACT_SHIFT = 1,
+    ACT_REDUCE = 2,
+    ACT_ACCEPT = 3
+};
+
+inline int encodeAction(ActionKind kind, int target) { return (target << 2) | kind; }
+inline ActionKind actionKind(int action) { return ActionKind(action & 3); }
+inline int actionTarget(int action) { return action >> 2; }
+
+// LR(0)自动机：状态为有序的项目集（含闭包），转移按符号升序排列
+struct LRAutomaton {
+    std::vector<std::vector<LR_item>> states;
+    std::vector<std::vector<std::pair<int, int>>> transitions;   // {符号, 目标状态}
+};
+
+// 以文法的第0个产生式为增广产生式构造LR(0)项集族。
+// threads > 1 时按BFS层并行扩展：每层的前沿状态由工作线程各自计算closure/goto，
+// 本层内已知状态表只读，无需加锁；新状态在层末按(源状态, 符号)顺序统一编号，
+// 因此状态编号与单线程构造完全一致。
+LRAutomaton buildLR0Automaton(const Grammar& grammar, unsigned threads = 1);
+
+// SLR分析表：以符号编号为列，action列只对终结符有效，gotoTable列只对非终结符有效
+struct SLRTable {
+    int symbolCount = 0;
+    std::vector<int> action;        // states x symbolCount，编码见encodeAction
+    std::vector<int> gotoTable;     // states x symbolCount，-1表示无转移
+    int conflicts = 0;              // 被后写入的动作覆盖的冲突项数
+
+    int stateCount() const { return symbolCount ? (int)(action.size() / symbolCount) : 0; }
+};
+
+// 按行并行填写SLR分析表（各行互不相交）。冲突时后写入者生效：
+// 先写移进，再按项目顺序写归约，与原先的逐项写入顺序一致。
+SLRTable buildSLRTable(const Grammar& grammar, const GrammarSets& sets,
+                       const LRAutomaton& automaton, unsigned threads = 1);
+
+#endif // LRAUTOMATON_H
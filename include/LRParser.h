@@ -3,10 +3,16 @@
 #define LRPARSER_H
 
 #include <string>
+#include <cstdint>
 #include <vector>
 #include <map>
 #include <set>
-#include <stack>
+#include <iosfwd>
+#include <memory>
+#include "LL1Parser.h"
+#include "OutputSink.h"
+#include "Grammar.h"
+#include "LRAutomaton.h"
 
 // 与之前代码兼容的TokenType枚举
 enum TokenType {
@@ -51,112 +57,231 @@ enum TokenType {
     NT_START
 };
 
-// 产生式结构
-struct Production {
-    int lhs;
-    std::vector<int> rhs;
-    Production(int l = 0, std::vector<int> r = {}) : lhs(l), rhs(r) {}
+// 终结符与非终结符在稠密分析表中的列数
+const int TERMINAL_COUNT = TOK_END + 1;
+const int NONTERMINAL_COUNT = NT_START - NT_PROGRAM + 1;
+
+// 记号批次的来源（流水线模式下由词法线程产生）：每个记号为{类型, 行号}，
+// nextBatch把下一批记号放入batch（原有内容被替换），输入结束后返回false
+class LRTokenSource {
+public:
+    virtual ~LRTokenSource() {}
+    virtual bool nextBatch(std::vector<std::pair<int, int>>& batch) = 0;
 };
 
-// LR项结构
-struct LR_item {
-    int productionId;
-    int dotPos;
+// 按需切分记号的输入流：不预先物化整个记号序列，内存占用与输入规模无关
+class LRTokenStream {
+public:
+    explicit LRTokenStream(const std::string& prog);
+    // 从source逐批读取已切分好的记号
+    explicit LRTokenStream(LRTokenSource& source);
 
-    LR_item(int pid = 0, int pos = 0) : productionId(pid), dotPos(pos) {}
+    // 当前记号 {类型, 行号}；输入耗尽后返回 {TOK_END, 最后一个记号的行号}
+    const std::pair<int, int>& current();
+    void advance();
+    // 在当前记号之前插入一个记号（错误恢复用）
+    void insert(int token, int lineNum);
+    // 输入中是否不含任何有效记号
+    bool empty();
 
-    bool operator<(const LR_item& other) const {
-        if (productionId != other.productionId)
-            return productionId < other.productionId;
-        return dotPos < other.dotPos;
-    }
+private:
+    void fetch();
 
-    bool operator==(const LR_item& other) const {
-        return productionId == other.productionId && dotPos == other.dotPos;
-    }
+    const std::string& src;
+    size_t pos;
+    int lineNum;
+    bool lineHasChars;
+    bool fetched;
+    bool seenToken;
+    std::pair<int, int> cur;
+    std::vector<std::pair<int, int>> pending;
+    LRTokenSource* source;
+    std::vector<std::pair<int, int>> batch;
+    size_t batchPos;
+    bool sourceDone;
 };
 
-// SLR解析器类
-class SLRParser {
+// SLR文法与分析表：构造完成后只读，所有成员函数均为const且不修改共享状态，
+// 因此一份实例可以被多个线程上的SLRParser同时使用，无需加锁，也不必每线程复制
+class SLRTables {
 private:
-    // 核心数据结构
     std::vector<Production> productions;
-    std::map<int, std::set<int>> firstSets;
-    std::map<int, std::set<int>> followSets;
-    std::vector<std::set<LR_item>> itemSets;
-    std::map<std::pair<int, int>, std::string> actionTable;
-    std::map<std::pair<int, int>, int> gotoTable;
-    
+    std::vector<int> actionTable;      // stateCount x TERMINAL_COUNT
+    std::vector<int> gotoTable;        // stateCount x NONTERMINAL_COUNT，-1表示无转移
+    std::vector<std::string> symbolNames;  // 终结符在前、非终结符在后的稠密编号
+    int numStates;
+    bool fromCache;
+
+    SLRTables();
+
+    // 文法初始化
+    void initializeProductions();
+    void initializeSymbolNames();
+
+    // LR(0)项集构造
+    LRAutomaton constructLR0ItemSets(const Grammar& grammar) const;
+
+    // SLR分析表构造
+    void constructParsingTable(const Grammar& grammar, const GrammarSets& sets, const LRAutomaton& automaton);
+
+    // 分析表二进制缓存
+    uint64_t grammarHash() const;
+    bool loadTables(const std::string& path);
+    bool saveTables(const std::string& path) const;
+    void buildTables();
+
+public:
+    // 构造分析表；tableCachePath非空时文法哈希匹配则直接加载，否则重新构造并写回
+    static std::shared_ptr<const SLRTables> create(const std::string& tableCachePath = std::string());
+    // 进程内共享的默认分析表，首次使用时构造一次（局部静态变量，初始化线程安全）
+    static std::shared_ptr<const SLRTables> shared();
+
+    int stateCount() const { return numStates; }
+    int action(int state, int token) const { return actionTable[state * TERMINAL_COUNT + token]; }
+    int gotoState(int state, int nonterminal) const { return gotoTable[state * NONTERMINAL_COUNT + nonterminal - NT_PROGRAM]; }
+    const Production& production(int prodId) const { return productions[prodId]; }
+
+    static int symbolIndex(int symbol);
+    static bool isTerminal(int symbol);
+    std::string symbolToString(int symbol) const;
+    // 产生式转字符串
+    std::string productionToString(int prodId) const;
+
+    // 文法描述（供FIRST/FOLLOW、LL(1)表等构造器共用）
+    Grammar grammarDescription() const;
+
+    // 分析表是否来自缓存文件
+    bool loadedFromCache() const { return fromCache; }
+
+    // 只做识别的表驱动分析：不做错误恢复，出错即返回false；
+    // reductions非空时按归约顺序记录产生式编号
+    bool recognize(const std::vector<int>& tokens, std::vector<int>* reductions) const;
+
+    // 生成直接编码的分析器源码：每个状态是一个带标号的代码块，
+    // 对向前看记号做switch，移进/GOTO直接跳转到目标状态的标号
+    void generateDirectCode(std::ostream& out) const;
+};
+
+// 解析事件的接收者：每次归约与每个语法错误按发生顺序送来
+class SLREventSink {
+public:
+    virtual ~SLREventSink() {}
+    virtual void reduced(int prodId) = 0;
+    virtual void syntaxError(int lineNum, const std::string& message) = 0;
+};
+
+// 把解析事件写入流。文本格式时错误即时输出为"语法错误，第N行，..."，归约不逐条输出，
+// 由finish按整个归约序列打印最右推导；NDJSON格式时输出reduce与diagnostic记录
+class SLRReportWriter : public SLREventSink {
+public:
+    // derivation为假时finish不打印最右推导
+    SLRReportWriter(const SLRTables& tables, std::ostream& out, ReportFormat format, bool derivation);
+    ~SLRReportWriter() override;
+
+    void reduced(int prodId) override;
+    void syntaxError(int lineNum, const std::string& message) override;
+    // 解析结束，reductions为全部归约
+    void finish(const std::vector<int>& reductions);
+
+    // 是否需要逐条接收归约
+    bool wantsReductions() const { return format == REPORT_NDJSON; }
+
+private:
+    const SLRTables& tables;
+    std::ostream& out;
+    ReportFormat format;
+    bool derivation;
+    std::unique_ptr<SinkFor> records;   // NDJSON格式时的输出
+    size_t steps;
+};
+
+// SLR解析器类：只保存一次解析的状态（栈、错误标记、归约序列、语法树），
+// 分析表通过shared_ptr共享。每个线程各用一个SLRParser即可并发解析。
+class SLRParser {
+private:
+    std::shared_ptr<const SLRTables> tables;
+
     // 解析状态
-    int stateCount;
-    std::vector<std::string> rightmostDerivation;
+    std::vector<int> reductions;       // 按归约顺序记录的产生式编号
+    bool recordDerivation;
+    TreeNode* syntaxTree;              // 与LL(1)分析器同构的语法树
+    bool buildTree;
     int errorCount;
     bool hasError;
     int errorLine;
     bool insertedSemicolon;
+    std::ostream* out;                 // 错误信息与最右推导的输出位置，默认为std::cout
+    ReportFormat format;               // REPORT_NDJSON时错误与归约按记录输出，不打印最右推导
+    SLREventSink* eventSink;           // 调用方指定的事件接收者，为空时按out与format输出
+    SLREventSink* events;              // 本次解析的事件接收者
+    bool reportReductions;             // 是否把每次归约送给events
 
     // 辅助方法
-    std::string symbolToString(int symbol);
-    bool isTerminal(int symbol);
-    bool isEpsilonProduction(const Production& prod);
-    
-    // 词法分析
-    std::vector<std::pair<int, int>> tokenize(const std::string& prog);
-    int getTokenType(const std::string& token);
-    
-    // 文法初始化
-    void initializeProductions();
-    
-    // LR项集操作
-    bool areItemSetsEqual(const std::set<LR_item>& set1, const std::set<LR_item>& set2);
-    std::set<LR_item> closure(const std::set<LR_item>& items);
-    std::set<LR_item> gotoFunction(const std::set<LR_item>& items, int symbol);
-    
-    // LR(0)项集构造
-    void constructLR0ItemSets();
-    
-    // First和Follow集计算
-    void calculateFirstSets();
-    void calculateFollowSets();
-    
-    // SLR分析表构造
-    void constructParsingTable();
-    
-    // 产生式转字符串
-    std::string productionToString(int prodId);
-    
+    std::string symbolToString(int symbol) const { return tables->symbolToString(symbol); }
+
+    bool parseTokens(LRTokenStream& tokens);
+
     // 错误处理
     bool handleError(int state, int token, int lineNum, 
-                    std::vector<std::pair<int, int>>& tokens, 
-                    size_t& tokenIndex, 
-                    std::stack<int>& stateStack, 
-                    std::stack<int>& symbolStack);
-    
-    // 字符串清理
-    std::string cleanString(const std::string& str);
+                    LRTokenStream& tokens, 
+                    std::vector<int>& stateStack, 
+                    std::vector<int>& symbolStack);
     
     // 解析动作处理
-    void processShiftAction(const std::string& action, 
-                           std::stack<int>& stateStack, 
-                           std::stack<int>& symbolStack, 
+    void processShiftAction(int action, 
+                           std::vector<int>& stateStack, 
+                           std::vector<int>& symbolStack, 
+                           std::vector<TreeNode*>& valueStack, 
                            int currentToken, 
-                           size_t& tokenIndex);
+                           LRTokenStream& tokens);
     
-    void processReduceAction(const std::string& action, 
-                            std::stack<int>& stateStack, 
-                            std::stack<int>& symbolStack);
+    bool processReduceAction(int action, 
+                            std::vector<int>& stateStack, 
+                            std::vector<int>& symbolStack, 
+                            std::vector<TreeNode*>& valueStack);
     
-    // 打印最右推导
-    void printDerivation();
-
 public:
+    // 使用进程内共享的默认分析表
     SLRParser();
+    // 使用分析表缓存文件：文法哈希匹配时直接加载，否则重新构造并写回
+    explicit SLRParser(const std::string& tableCachePath);
+    // 使用调用方提供的共享分析表
+    explicit SLRParser(std::shared_ptr<const SLRTables> sharedTables);
+    ~SLRParser();
+    SLRParser(const SLRParser&) = delete;
+    SLRParser& operator=(const SLRParser&) = delete;
     bool parse(const std::string& prog);
+    // 从记号批次解析（流水线模式），其余与parse(prog)相同
+    bool parse(LRTokenSource& source);
     
     // 获取解析结果
     bool hasErrorOccurred() const { return hasError; }
     int getErrorLine() const { return errorLine; }
-    const std::vector<std::string>& getDerivation() const { return rightmostDerivation; }
+    std::vector<std::string> getDerivation();
+    const std::vector<int>& getReductions() const { return reductions; }
+
+    // 语法树（开启setBuildTree且解析到达acc时有效，否则为nullptr），由SLRParser持有
+    TreeNode* getSyntaxTree() const { return syntaxTree; }
+
+    // 关闭后不记录也不打印最右推导，解析内存只随栈深度增长
+    void setRecordDerivation(bool enable) { recordDerivation = enable; }
+    // 改变输出位置，各线程的SLRParser各自指定输出时可并发解析
+    void setOutput(std::ostream& os) { out = &os; }
+    // NDJSON格式时解析过程中每次归约输出一条reduce记录，错误输出diagnostic记录
+    void setReportFormat(ReportFormat f) { format = f; }
+    // 设置后错误与每次归约都交给sink，不写入out，也不打印最右推导；传nullptr恢复
+    void setEventSink(SLREventSink* sink) { eventSink = sink; }
+    // 开启后构造语法树（默认关闭，此时解析内存只随栈深度增长）
+    void setBuildTree(bool enable) { buildTree = enable; }
+
+    // 解析所用的分析表
+    const SLRTables& getTables() const { return *tables; }
+    const std::shared_ptr<const SLRTables>& sharedTables() const { return tables; }
+
+    // 把源程序切分为记号类型序列（以TOK_END结尾）
+    static std::vector<int> tokenTypes(const std::string& prog);
+    // 按归约序列打印最右推导
+    static void printDerivation(const SLRTables& tables, const std::vector<int>& reductions, std::ostream& out);
 };
 
 
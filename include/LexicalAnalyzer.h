@@ -2,6 +2,7 @@
 #ifndef LEXICAL_ANALYZER_H
 #define LEXICAL_ANALYZER_H
 
+#include <ostream>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -20,6 +21,11 @@ public:
     
     // 获取分析结果
     std::vector<Token> getTokens() const;
+
+    // 输出"分析结果 (N个词法单元):"与逐行的<key, value>列表
+    void printTokens(std::ostream& out) const;
+    // 每个词法单元一条token记录（见OutputSink.h的NdjsonRecord）
+    void writeNdjson(std::ostream& out) const;
     
     // 清空结果
     void clear();
@@ -0,0 +1,139 @@
+// OutputSink.h
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+// 带大缓冲区的输出目标：文件描述符、FILE*、另一个streambuf或内存。
+// 本身是std::streambuf，可以交给std::ostream使用；各打印函数直接用operator<<写入，
+// 整数与浮点数用std::to_chars格式化（浮点数与ostream默认格式相同，即%g）。
+// 缓冲区满、调用flush()或析构时才写出到目标。std::endl/std::flush引起的sync
+// 不写出，所以逐行输出也只在缓冲区满时产生一次系统调用。
+// 同一个OutputSink不能被多个线程同时写入。
+class OutputSink : public std::streambuf {
+public:
+    static const size_t DEFAULT_CAPACITY = 1 << 20;
+
+    // 写入内存，内容由view()/take()取出
+    OutputSink();
+    // 写入文件描述符，不负责关闭
+    explicit OutputSink(int fd, size_t capacity = DEFAULT_CAPACITY);
+    // 经fwrite成块写入，不负责关闭
+    explicit OutputSink(std::FILE* file, size_t capacity = DEFAULT_CAPACITY);
+    // 成块转发到另一个streambuf（如std::cout.rdbuf()）
+    explicit OutputSink(std::streambuf* target, size_t capacity = DEFAULT_CAPACITY);
+    ~OutputSink() override;
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    // 以写方式打开文件；失败时返回空并在failure中说明原因
+    static std::unique_ptr<OutputSink> openFile(const std::string& path, std::string& failure);
+
+    OutputSink& write(const char* p, size_t n);
+    OutputSink& operator<<(std::string_view s) { return write(s.data(), s.size()); }
+    OutputSink& operator<<(char c);
+    OutputSink& operator<<(int v) { return operator<<((long long)v); }
+    OutputSink& operator<<(long v) { return operator<<((long long)v); }
+    OutputSink& operator<<(long long v);
+    OutputSink& operator<<(unsigned v) { return operator<<((unsigned long long)v); }
+    OutputSink& operator<<(unsigned long v) { return operator<<((unsigned long long)v); }
+    OutputSink& operator<<(unsigned long long v);
+    OutputSink& operator<<(double v);
+    // 重复输出n次s（缩进等）
+    OutputSink& repeat(std::string_view s, size_t n);
+    // 能精确还原的最短十进制表示；JSON不能表示的inf/nan输出null
+    OutputSink& exact(double v);
+    // 带引号的JSON字符串，转义引号、反斜杠与控制字符
+    OutputSink& jsonString(std::string_view s);
+
+    // 把缓冲区写出到目标；写入失败后返回false，其后的输出被丢弃
+    bool flush();
+    bool failed() const { return error; }
+
+    // 内存目标：已写入的内容；take取出内容并清空
+    std::string_view view() const { return std::string_view(pbase(), (size_t)(pptr() - pbase())); }
+    std::string take();
+
+    // out的streambuf是OutputSink时返回它，否则返回nullptr
+    static OutputSink* of(std::ostream& out);
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override { return 0; }
+
+private:
+    enum Target { TARGET_MEMORY, TARGET_FD, TARGET_FILE, TARGET_STREAMBUF };
+    Target target;
+    int fd = -1;
+    std::FILE* file = nullptr;
+    std::streambuf* forward = nullptr;
+    bool ownsFile = false;
+    bool error = false;
+    std::string buffer;
+
+    void reset(size_t used);
+    void bump(size_t n);
+    // 保证缓冲区至少还有n字节空闲（外部目标时n不超过容量）
+    char* reserve(size_t n);
+    bool emit(const char* p, size_t n);
+};
+
+// 打印函数统一写入OutputSink：out的streambuf已是OutputSink时直接写入，
+// 否则建立一个转发到out的OutputSink，析构时写出
+class SinkFor {
+public:
+    explicit SinkFor(std::ostream& out);
+    OutputSink& operator*() { return *sink; }
+    OutputSink* operator->() { return sink; }
+
+private:
+    std::unique_ptr<OutputSink> own;
+    OutputSink* sink;
+};
+
+// 分析结果的输出格式：与交互模式相同的文本，或每行一条JSON记录（NDJSON）
+enum ReportFormat {
+    REPORT_TEXT,
+    REPORT_NDJSON
+};
+
+// 一条NDJSON记录：构造时写出{"record":"类别"，析构时写出}与换行。
+// 各分析阶段的记录：
+//   token       index, key, value                  词法单元（LexicalAnalysis）
+//   node        id, parent, depth, label[, line]   语法树结点，先序（LL(1)分析器）
+//   reduce      step, production, lhs, rule        每次归约，按归约顺序（SLR分析器）
+//   var         name, type, value                  变量的最终值（语义分析）
+//   diagnostic  phase[, line], message             词法/语法/语义错误；语义错误没有line
+// reduce与SLR的diagnostic在解析过程中逐条写出；token、node与语义分析的记录在该阶段结束后写出
+class NdjsonRecord {
+public:
+    NdjsonRecord(OutputSink& sink, std::string_view record);
+    ~NdjsonRecord() { sink << "}\n"; }
+    NdjsonRecord(const NdjsonRecord&) = delete;
+    NdjsonRecord& operator=(const NdjsonRecord&) = delete;
+
+    NdjsonRecord& field(std::string_view key, std::string_view value);
+    NdjsonRecord& field(std::string_view key, const char* value) { return field(key, std::string_view(value)); }
+    NdjsonRecord& field(std::string_view key, const std::string& value) { return field(key, std::string_view(value)); }
+    NdjsonRecord& field(std::string_view key, bool value);
+    NdjsonRecord& field(std::string_view key, double value);
+    // 整数
+    template <typename T>
+    NdjsonRecord& field(std::string_view key, T value) {
+        name(key);
+        sink << value;
+        return *this;
+    }
+
+private:
+    OutputSink& sink;
+    void name(std::string_view key);
+};
+
+#endif // OUTPUT_SINK_H
@@ -0,0 +1,16 @@
+// SLRDirect.h
+#ifndef SLRDIRECT_H
+#define SLRDIRECT_H
+
+#include <vector>
+
+// 直接编码的SLR分析器：构建时由slr_codegen根据SLR分析表生成（SLRDirect.cpp）。
+// 每个状态编译为一个带标号的代码块，对向前看记号做switch，不再查表。
+// 约定与SLRTables::recognize相同：tokens为以TOK_END结尾的记号类型序列，
+// 不做错误恢复，出错返回false；reductions非空时按归约顺序记录产生式编号。
+bool slrDirectParse(const std::vector<int>& tokens, std::vector<int>* reductions);
+
+// 生成时分析表的状态数
+extern const int SLR_DIRECT_STATE_COUNT;
+
+#endif // SLRDIRECT_H
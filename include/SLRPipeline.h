@@ -0,0 +1,138 @@
+// SLRPipeline.h
+#ifndef SLR_PIPELINE_H
+#define SLR_PIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "LRParser.h"
+
+// 有界的单生产者/单消费者无锁环形队列：生产者只写tail，消费者只写head，
+// 两者分处不同缓存行。容量向上取为2的幂。
+// 队列满或空时自旋让出CPU，等待的时间计入调用方给出的stallNanos。
+// abort()使双方的push/pop立即返回false，用于某一阶段出错时让其他阶段退出。
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        slots.resize(n);
+        mask = n - 1;
+    }
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    bool tryPush(T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false;
+        slots[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 队列满时等待；已abort时返回false
+    bool push(T& item, long long& stallNanos) {
+        if (tryPush(item)) return true;
+        auto start = std::chrono::steady_clock::now();
+        bool pushed = false;
+        while (!aborted.load(std::memory_order_acquire) && !(pushed = tryPush(item))) std::this_thread::yield();
+        stallNanos += elapsedNanos(start);
+        return pushed;
+    }
+
+    // 队列空时等待；生产者close()后取完剩余元素、或已abort时返回false
+    bool pop(T& item, long long& stallNanos) {
+        if (tryPop(item)) return true;
+        auto start = std::chrono::steady_clock::now();
+        bool popped = false;
+        while (!aborted.load(std::memory_order_acquire)) {
+            bool done = closed.load(std::memory_order_acquire);
+            if ((popped = tryPop(item)) || done) break;
+            std::this_thread::yield();
+        }
+        stallNanos += elapsedNanos(start);
+        return popped;
+    }
+
+    // 生产者不再写入
+    void close() { closed.store(true, std::memory_order_release); }
+    void abort() { aborted.store(true, std::memory_order_release); }
+
+private:
+    static long long elapsedNanos(std::chrono::steady_clock::time_point start) {
+        return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::vector<T> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<bool> closed{false};
+    std::atomic<bool> aborted{false};
+};
+
+// 一次流水线解析的耗时（毫秒）。各阶段的等待分为等输入（上游队列空）与等输出（下游队列满）
+struct SLRPipelineStats {
+    double totalMillis = 0;         // 端到端：从开始切分记号到输出完最后一个结果
+    double lexOutputStall = 0;      // 词法线程等待记号队列的空位
+    double parseInputStall = 0;     // 语法线程等待记号
+    double parseOutputStall = 0;    // 语法线程等待事件队列的空位
+    double reportInputStall = 0;    // 输出阶段等待解析事件
+    size_t tokens = 0;
+    size_t tokenBatches = 0;
+    size_t eventBatches = 0;
+
+    // 一行文字汇总，供--stats输出
+    void print(std::ostream& out) const;
+};
+
+// 流水线模式的SLR分析：词法、语法、输出三个阶段分别在各自的线程上运行，
+// 相邻阶段之间用SpscRing传递记号批次与解析事件（归约、语法错误）批次，各阶段重叠执行。
+// 输出（错误信息、最右推导或NDJSON记录）与SLRParser::parse(prog)逐字节相同。
+// 一个SLRPipeline同一时刻只能运行一次解析；分析表可以与其他解析器共享。
+class SLRPipeline {
+public:
+    explicit SLRPipeline(std::shared_ptr<const SLRTables> tables);
+
+    // 成功（无语法错误）时返回true；某一阶段抛出的异常在三个线程都结束后重新抛出
+    bool parse(const std::string& prog);
+
+    void setOutput(std::ostream& os) { out = &os; }
+    void setReportFormat(ReportFormat f) { format = f; }
+    // 文本格式时是否在末尾打印最右推导
+    void setRecordDerivation(bool enable) { recordDerivation = enable; }
+    // 每批的记号数/事件数与队列的批次容量
+    void setBatchSize(size_t n) { batchSize = n ? n : 1; }
+    void setQueueCapacity(size_t n) { queueCapacity = n; }
+
+    int getErrorLine() const { return errorLine; }
+    const SLRPipelineStats& stats() const { return lastStats; }
+
+private:
+    std::shared_ptr<const SLRTables> tables;
+    std::ostream* out;
+    ReportFormat format;
+    bool recordDerivation;
+    size_t batchSize;
+    size_t queueCapacity;
+    int errorLine;
+    SLRPipelineStats lastStats;
+};
+
+#endif // SLR_PIPELINE_H
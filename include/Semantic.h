@@ -4,16 +4,18 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
-
-// 变量结构体
-struct Var {
-    std::string type;   // int / real
-    double value;
-};
+#include "SemanticAST.h"
+#include "SemanticBatch.h"
+#include "SemanticBudget.h"
+#include "SemanticIR.h"
+#include "SemanticJIT.h"
+#include "SemanticProfile.h"
+#include "SemanticTypeCheck.h"
+#include "SymbolTable.h"
 
 // 语义分析器类
 class SemanticAnalyzer {
@@ -21,37 +23,110 @@ private:
     // 全局数据
     std::vector<std::string> tokens;
     int posi;
-    std::map<std::string, Var> symtab;
+    SymbolTable symtab;
+    std::vector<int> tokenSlots;       // 变量引用处记号对应的槽位，其余为-1
+    std::vector<int> stmtEnds;         // 语句起始记号 -> 语句结束后的位置，其余为-1
+    SemTypeInfo typeInfo;              // 当前程序的静态类型检查结果
     std::vector<std::string> errors;
     bool flag;
+    bool useBytecode;
+    bool optimize;
+    bool useJit;
+    bool profiling;
+    IRPassReport passReport;           // 最近一次优化的各遍统计
+    SemJitStats jitReport;             // 最近一次执行的JIT编译与执行耗时
+    SemBudget budget;
+    const SemCancelToken* cancelToken;
+    SemBudgetMeter meter;              // 最近一次分析的预算计量
+    SemProfile profileData;            // 最近一次剖析的结果
+    std::vector<int> tokenLines;       // 剖析时各记号所在的行号
+    std::vector<int> stmtIds;          // 剖析时语句起始记号 -> 语句下标，其余为-1
+    uint64_t childNanos;               // 剖析时当前语句内已执行的内层语句总耗时
     
     // 工具函数
     void error(const std::string& msg);
-    std::string peek();
-    std::string get();
+    void record(const std::string& msg);
+    const std::string& peek();
+    const std::string& get();
     bool isID(const std::string& s);
     bool isInt(const std::string& s);
     bool isReal(const std::string& s);
     
     // 表达式相关
-    std::pair<std::string, double> arithexpr();
-    std::pair<std::string, double> simpleexpr();
-    std::pair<std::string, double> multexpr();
+    SemValue arithexpr();
+    SemValue simpleexpr();
+    SemValue multexpr();
     bool boolexpr();
     
     // 语句相关
     void stmt(bool execute);
+    void statement(bool execute);
+    void profiledStmt();
+    void countBranch(int start, bool cond);
     void compoundstmt(bool execute);
     void assgstmt(bool execute);
     void ifstmt(bool execute);
+    void whilestmt(bool execute);
     
     // 声明相关
     void decls();
+
+    // 前端：声明、语法树、名字解析与静态类型检查；reportParseErrors为真时立即报告语法错误
+    SemProgram frontEnd(const std::string& prog, bool reportParseErrors, std::vector<int>& varSlots);
+
+    // 名字解析：把语法树中的变量映射到符号表槽位，未声明的变量在此报告一次
+    std::vector<int> resolve(const SemProgram& program);
+    int slotAt(int pos);
+    // 由语法树登记每条语句的结束位置（含复合语句的匹配右括号），用于跳过不执行的语句
+    void indexStatements(const SemProgram& program);
+    // 逐记号解释执行并逐条语句计数、计时
+    void profileInterpreter(const SemProgram& program);
+
+    // 把复合语句部分生成三地址码、优化后编译为字节码，在虚拟机上执行
+    void runBytecode(const SemProgram& program, const std::vector<int>& varSlots);
+    // 执行一个版本的三地址码：启用JIT时编译为机器码执行，无法编译时退回虚拟机
+    bool execute(const IRFunction& fn, SemanticVM::Mode mode);
+    // 登记三地址码及其执行帧的内存
+    bool chargeIR(const IRFunction& fn);
     
 public:
     SemanticAnalyzer();
     void analyze(const std::string& prog);
-    void printResults() const;
+    // 默认用字节码虚拟机执行；关闭后退回逐记号解释（参照实现）
+    void setUseBytecode(bool enable) { useBytecode = enable; }
+    // 默认在生成字节码前运行优化流水线；关闭后直接执行未优化的三地址码
+    void setOptimize(bool enable) { optimize = enable; }
+    // 启用后把三地址码编译为本机代码执行（仅x86-64类Unix平台，其他平台仍用虚拟机）
+    void setUseJit(bool enable) { useJit = enable; }
+    // 执行预算与取消令牌（见SemanticBudget.h），对之后的每次分析生效；令牌由调用方持有
+    void setBudget(const SemBudget& limits) { budget = limits; }
+    void setCancelToken(const SemCancelToken* token) { cancelToken = token; }
+    // 语句级剖析：开启后改用逐记号解释执行（优化后的代码已不再保留语句边界），
+    // 统计每条语句与每行的执行次数、耗时及条件的成立次数；关闭时不产生额外开销
+    void setProfiling(bool enable) { profiling = enable; }
+    void printResults(std::ostream& out = std::cout) const;
+    // printResults的NDJSON形式：每条错误一条diagnostic记录；没有错误时每个变量
+    // 按符号表顺序一条var记录，real的值为能精确还原的最短表示
+    void writeNdjson(std::ostream& out) const;
+    // 生成x86-64汇编形式的独立程序，运行后的输出与analyze加printResults相同；
+    // 无法生成时返回false并在failure中说明原因
+    bool compileToAssembly(const std::string& prog, std::ostream& out, std::string& failure);
+    // 批量执行：程序只分析一次，按inputs的每一行取变量初始值执行，结果按变量写成列，
+    // 每行的结果与以该行初始值单独analyze相同；输入列不匹配时返回false并在failure中说明原因
+    bool analyzeBatch(const std::string& prog, const SemBatchTable& inputs, SemBatchResult& out,
+                      std::string& failure);
+
+    // 分析结束后的符号表与错误信息
+    const SymbolTable& symbols() const { return symtab; }
+    const std::vector<std::string>& errorMessages() const { return errors; }
+    const SemTypeInfo& types() const { return typeInfo; }
+    const IRPassReport& optimizationReport() const { return passReport; }
+    const SemJitStats& jitStats() const { return jitReport; }
+    // 最近一次分析是否因预算或取消而中止；中止时最后一条错误信息说明原因，变量的值不完整
+    SemAbortReason abortReason() const { return meter.abortReason(); }
+    const SemBudgetMeter& budgetUsage() const { return meter; }
+    // 最近一次开启剖析的分析结果；执行前出错（如嵌套过深）时为空
+    const SemProfile& profile() const { return profileData; }
 };
 
 #endif // SEMANTIC_H
\ No newline at end of file
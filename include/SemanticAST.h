@@ -0,0 +1,61 @@
+// SemanticAST.h
+#ifndef SEMANTICAST_H
+#define SEMANTICAST_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SemanticValue.h"
+
+// 表达式结点：所有结点按后序存放在SemProgram::exprs中，以下标互相引用；
+// 一个结点的子树占据紧邻其前的一段连续下标，起点是沿lhs一直向下到达的叶结点
+struct SemExpr {
+    enum Kind : uint8_t { NUM, VAR, BINARY };
+
+    Kind kind;
+    char op;            // BINARY: + - * /
+    SemValue value;     // NUM: 字面量
+    int var;            // VAR: 变量编号
+    int lhs, rhs;       // BINARY: 左右操作数
+};
+
+// 条件 lhs op rhs
+struct SemCond {
+    int lhs, rhs;
+    SemRelOp op;
+};
+
+// 语句结点
+struct SemStmt {
+    enum Kind : uint8_t { ASSIGN, IF, WHILE, BLOCK };
+
+    Kind kind;
+    int var;                    // ASSIGN: 目标变量编号
+    int expr;                   // ASSIGN: 右部表达式
+    SemCond cond;               // IF/WHILE
+    int body;                   // IF: then分支；WHILE: 循环体
+    int elseBody;               // IF: else分支
+    std::vector<int> children;  // BLOCK: 子语句
+    size_t begin, end;          // 语句在记号序列中的范围 [begin, end)
+};
+
+// 复合语句部分的语法树；变量按首次出现的顺序编号
+struct SemProgram {
+    std::vector<std::string> varNames;
+    std::vector<std::pair<size_t, int>> varRefs;   // 变量的每次出现 {记号下标, 变量编号}
+    std::vector<SemExpr> exprs;
+    std::vector<SemStmt> stmts;
+    int body = -1;                      // 最外层复合语句
+    std::vector<std::string> errors;    // 语法错误信息，按出现顺序
+    bool tooDeep = false;               // 嵌套超过上限，分析提前停止，语法树不完整
+};
+
+// 从tokens[start]处的复合语句开始建立语法树。
+// 与逐记号解释的写法一致，分隔符（= ; ( ) then else）只跳过不检查；
+// 非法的表达式记一次错误并按值为0处理，输入提前结束时停止。
+// maxDepth限制语句嵌套与括号嵌套（0为不限），超出时置tooDeep并停止。
+// 左结合的长运算链不受限制，遍历表达式的各遍都不递归。
+SemProgram parseSemanticProgram(const std::vector<std::string>& tokens, size_t start, int maxDepth = 0);
+
+#endif // SEMANTICAST_H
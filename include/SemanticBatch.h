@@ -0,0 +1,61 @@
+// SemanticBatch.h
+#ifndef SEMANTICBATCH_H
+#define SEMANTICBATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SemanticBudget.h"
+#include "SemanticIR.h"
+#include "SymbolTable.h"
+
+// 一列数据：int列使用ints，real列使用reals
+struct SemColumn {
+    std::string name;
+    SemType type = SEM_INT;
+    std::vector<int64_t> ints;
+    std::vector<double> reals;
+
+    size_t size() const { return type == SEM_REAL ? reals.size() : ints.size(); }
+};
+
+// 列式输入：每列给出一个已声明变量在各行的初始值，未给出的变量取声明头中的值
+struct SemBatchTable {
+    size_t rows = 0;
+    std::vector<SemColumn> columns;
+
+    const SemColumn* find(const std::string& name) const;
+};
+
+struct SemBatchResult {
+    size_t rows = 0;
+    std::vector<SemColumn> columns;         // 每个变量一列，顺序同符号表槽位
+    std::vector<std::string> staticErrors;  // 执行前报告的错误，各行相同
+    std::vector<uint32_t> divisionErrors;   // 每行执行中除零的次数
+    size_t preciseRows = 0;                 // 推测执行放弃后改为精确执行的行数
+
+    const SemColumn* find(const std::string& name) const;
+    // 第row行的错误信息，与以该行的初始值单独analyze后的errorMessages()相同
+    std::vector<std::string> errorMessages(size_t row) const;
+};
+
+// 批量执行：同一程序按行取不同的初始值执行，结果按变量写成列。
+//
+// 每SEM_BATCH_LANES行为一组，帧按“槽位 × 行”排列，每条三地址码指令对整组执行一次，
+// 循环体是定长的逐行运算，由编译器向量化为SIMD指令。各行可走不同的分支：每行记录
+// 自己所在的块，每次取所在块编号最小的那些行作为活动掩码执行该块，写入只对掩码内的行
+// 生效；由于块按程序顺序排列，条件语句的两个分支在汇合块处、循环在出口块处重新合并。
+//
+// optimized非空且没有静态错误时先执行优化版本（假定不出错，见SemanticVM::SPECULATIVE），
+// 出现除零的行放弃，之后对这些行精确执行precise。
+//
+// meter非空时，一组行每次回到编号不大于上一块的块（即循环的一轮）计一步，
+// 并登记帧与结果列的内存；预算用完或被取消时返回false，failure为中止原因。
+const int SEM_BATCH_LANES = 64;
+
+bool runSemanticBatch(const IRFunction* optimized, const IRFunction& precise, const SymbolTable& symbols,
+                      const std::vector<std::string>& staticErrors, const SemBatchTable& inputs,
+                      SemBatchResult& out, std::string& failure, SemBudgetMeter* meter = nullptr);
+
+#endif // SEMANTICBATCH_H
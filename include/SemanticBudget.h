@@ -0,0 +1,96 @@
+// SemanticBudget.h
+#ifndef SEMANTICBUDGET_H
+#define SEMANTICBUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// 执行预算，0表示不限。步数按回跳（循环的每一轮）计；内存按记号、语法树、三地址码、帧与错误信息
+// 等主要数据结构估算；墙钟时间从analyze开始计；嵌套深度限制语句嵌套与括号嵌套，
+// 超出时不再分析，避免按语句递归的各遍栈溢出（表达式的遍历不递归，长运算链不受限制）。
+struct SemBudget {
+    uint64_t maxSteps = 0;
+    size_t maxMemory = 0;
+    double maxMillis = 0;
+    int maxDepth = 4096;
+    // 每执行这么多步才检查一次时间与取消，两次检查之间的开销只是一次递减
+    int64_t checkInterval = 1024;
+};
+
+// 取消令牌：其他线程调用cancel后，执行在下一次检查时中止
+class SemCancelToken {
+public:
+    void cancel() { flag.store(true, std::memory_order_relaxed); }
+    void reset() { flag.store(false, std::memory_order_relaxed); }
+    bool cancelled() const { return flag.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> flag{ false };
+};
+
+enum SemAbortReason : uint8_t {
+    SEM_ABORT_NONE = 0,
+    SEM_ABORT_STEPS,
+    SEM_ABORT_MEMORY,
+    SEM_ABORT_TIME,
+    SEM_ABORT_DEPTH,
+    SEM_ABORT_CANCELLED
+};
+
+// 中止原因对应的错误信息（不含"error message:line"前缀）
+const char* semAbortMessage(SemAbortReason reason);
+
+// 一次执行的预算计量。步数以“额度”分段发放：热路径只递减fuel，
+// 额度用完时才进入refuel，在那里累计步数并检查步数、时间与取消。
+class SemBudgetMeter {
+public:
+    void start(const SemBudget& budget, const SemCancelToken* token);
+
+    // 是否需要在回跳处计步（设置了步数或时间预算，或有取消令牌）
+    bool armed() const { return stepChecks; }
+
+    // 计一步，应中止时返回false
+    bool tick() {
+        if (fuel > 0) {
+            fuel--;
+            return true;
+        }
+        return refuel() >= 0;
+    }
+
+    // 当前额度用完时调用：计入已用步数、检查预算与取消，并消耗一步；
+    // 返回新额度中剩余的步数，应中止时返回-1
+    int64_t refuel();
+
+    // 不计步的检查（阶段之间）：时间与取消
+    bool poll();
+
+    // 登记将要分配的内存，超出预算时返回false
+    bool charge(size_t bytes);
+
+    void abort(SemAbortReason why);
+    bool aborted() const { return reason != SEM_ABORT_NONE; }
+    SemAbortReason abortReason() const { return reason; }
+
+    uint64_t steps() const { return used + (uint64_t)(chunk - fuel); }
+    size_t memory() const { return bytes; }
+
+    int64_t fuel = 0;           // 当前额度中剩余的步数，字节码与JIT代码直接递减
+
+private:
+    SemBudget limits;
+    const SemCancelToken* cancel = nullptr;
+    bool stepChecks = false;
+    bool timed = false;
+    std::chrono::steady_clock::time_point deadline;
+    SemAbortReason reason = SEM_ABORT_NONE;
+    uint64_t used = 0;          // 已用完的额度累计的步数
+    int64_t chunk = 0;          // 当前额度的大小
+    size_t bytes = 0;
+
+    int64_t nextChunk() const;
+};
+
+#endif // SEMANTICBUDGET_H
@@ -0,0 +1,27 @@
+// SemanticCodegen.h
+#ifndef SEMANTICCODEGEN_H
+#define SEMANTICCODEGEN_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "SemanticIR.h"
+#include "SymbolTable.h"
+
+// x86-64代码生成：输出GNU as可汇编的AT&T语法汇编（System V ABI，链接libc的printf），
+// 用系统工具链汇编链接后即为独立程序，输出与SemanticAnalyzer::printResults一致。
+//
+// 寄存器分配：使用次数最多的int变量放在被调用者保存的通用寄存器（rbx、rbp、r12-r15），
+// real变量放在xmm8-xmm13；块内临时值按生存期线性扫描分配rcx、rsi、rdi、r8-r10与
+// xmm0-xmm7，分配不下时溢出到栈上。rax、rdx、r11、xmm14、xmm15为暂存寄存器。
+//
+// 与虚拟机相同，生成两个版本：optimized按“执行中不出错”的假定执行，除零时放弃，
+// 由main把变量恢复为初始值后改为执行precise（出错后不再赋值、除零报错并保留左值）。
+// staticErrors为执行前已报告的错误，非空时只执行precise。
+//
+// 变量a、b、c必须已声明（与printResults相同）。无法生成时返回false并在failure中说明原因。
+bool generateSemanticAssembly(const IRFunction& optimized, const IRFunction& precise,
+                              const SymbolTable& symbols, const std::vector<std::string>& staticErrors,
+                              std::ostream& out, std::string& failure);
+
+#endif // SEMANTICCODEGEN_H
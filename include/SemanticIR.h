@@ -0,0 +1,107 @@
+// SemanticIR.h
+#ifndef SEMANTICIR_H
+#define SEMANTICIR_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include "SemanticAST.h"
+#include "SemanticTypeCheck.h"
+
+// 三地址码中间表示。程序划分为基本块，块内是不含控制流的指令序列，块尾是终结指令。
+//
+// 操作数编码：低2位为种类，其余位为下标
+//   IR_VAR   变量，下标即符号表槽位，可被多次赋值
+//   IR_CONST 常量池中的常量
+//   IR_TEMP  临时值，只被定义一次且只在定义它的基本块内使用
+enum IROperandKind {
+    IR_VAR = 0,
+    IR_CONST = 1,
+    IR_TEMP = 2
+};
+
+inline int irOperand(IROperandKind kind, int index) { return (index << 2) | kind; }
+inline IROperandKind irKind(int operand) { return IROperandKind(operand & 3); }
+inline int irIndex(int operand) { return operand >> 2; }
+
+// 指令的类型已由静态类型检查确定：I前缀为64位整数运算，R前缀为double运算
+enum IROp : uint8_t {
+    IR_COPY,        // dst = a
+    IR_I2R,         // dst = (double)a
+    IR_IADD,        // dst = a op b
+    IR_ISUB,
+    IR_IMUL,
+    IR_IDIV,        // 除数为0时报错并令dst = a
+    IR_RADD,
+    IR_RSUB,
+    IR_RMUL,
+    IR_RDIV,
+    IR_STORE        // 变量dst = a；出现错误后不再生效
+};
+
+struct IRInstr {
+    IROp op;
+    int dst, a, b;
+};
+
+enum IRTerminator : uint8_t {
+    IR_HALT,
+    IR_JUMP,        // 转到succ[0]
+    IR_BRANCH       // lhs rel rhs 成立转到succ[0]，否则转到succ[1]
+};
+
+struct IRBlock {
+    std::vector<IRInstr> code;
+    IRTerminator term = IR_HALT;
+    SemRelOp rel = REL_INVALID;
+    bool realCompare = false;
+    int lhs = 0, rhs = 0;
+    int succ[2] = { -1, -1 };
+};
+
+struct IRFunction {
+    int varCount = 0;
+    std::vector<SemValue> constants;
+    int tempCount = 0;
+    std::vector<IRBlock> blocks;            // blocks[0]为入口
+    // 非空时为各变量在入口处的已知值，常量传播据此把程序特化到本次输入
+    std::vector<SemValue> entryValues;
+
+    int addConst(SemValue v);               // 相同的常量共用一个下标，返回操作数
+    int newTemp() { return irOperand(IR_TEMP, tempCount++); }
+    size_t instrCount() const;              // 指令数，终结指令计为一条
+
+private:
+    std::unordered_map<int64_t, int> constIndex[3];     // 按类型标记分开：8字节的值 -> 常量下标
+};
+
+// 由语法树生成三地址码；varSlots、types分别为名字解析与静态类型检查的结果，
+// varCount为符号表的槽位数
+IRFunction lowerSemanticProgram(const SemProgram& program, const std::vector<int>& varSlots,
+                                const SemTypeInfo& types, int varCount);
+
+// 以文本形式输出，调试用
+void printIR(const IRFunction& fn, std::ostream& out);
+
+// 各优化遍的统计
+struct IRPassStats {
+    std::string name;
+    double micros = 0;
+    size_t instrsBefore = 0, instrsAfter = 0;
+    size_t blocksBefore = 0, blocksAfter = 0;
+    int changes = 0;                        // 本遍的改写次数（折叠/替换/删除的项数）
+};
+
+struct IRPassReport {
+    std::vector<IRPassStats> passes;
+    void print(std::ostream& out) const;
+};
+
+// 优化流水线：常量折叠与传播、常量条件分支消除、复写传播、公共子表达式消除、
+// 死代码删除。优化以“执行中不出现错误”为前提：除数可能为0的除法不会被删除或折叠，
+// 由后端在除零时放弃优化结果、改用未优化的代码重新执行。
+IRPassReport optimizeIR(IRFunction& fn);
+
+#endif // SEMANTICIR_H
@@ -0,0 +1,54 @@
+// SemanticJIT.h
+#ifndef SEMANTICJIT_H
+#define SEMANTICJIT_H
+
+#include <cstddef>
+#include <vector>
+#include "SemanticIR.h"
+#include "SemanticVM.h"
+
+// 最近一次执行中JIT的统计：编译（生成机器码并映射为可执行页）与执行分别计时，单位微秒
+struct SemJitStats {
+    int functions = 0;          // 成功编译并执行的函数个数（推测执行放弃后还会编译精确版本）
+    int fallbacks = 0;          // 无法编译、退回虚拟机的次数
+    double compileMicros = 0;
+    double executeMicros = 0;
+};
+
+// 进程内JIT：把三地址码直接编码为x86-64机器码并调用，语义与SemanticVM相同（见SemanticVM::Mode）。
+// 帧布局与字节码一致（变量、常量、临时值），生成的代码以rbx为帧基址逐条访问帧，
+// 除零报错时调用回到C++的报错函数。代码先写入可读写的匿名映射，写完后改为只读可执行（W^X）。
+// 只支持x86-64上的System V ABI（Linux等类Unix系统），其他平台compile返回false，由调用方退回虚拟机。
+class SemJitFunction {
+public:
+    SemJitFunction() = default;
+    ~SemJitFunction();
+    SemJitFunction(const SemJitFunction&) = delete;
+    SemJitFunction& operator=(const SemJitFunction&) = delete;
+
+    // 当前平台能否使用JIT
+    static bool supported();
+
+    // 编译fn；失败时返回false。budgetChecks为真时在每个回跳前计步（同OP_BUDGET）
+    bool compile(const IRFunction& fn, SemanticVM::Mode mode, bool budgetChecks = false);
+
+    // 参数与返回值同SemanticVM::run；onError抛出的异常在生成的代码返回后重新抛出
+    bool run(SemValue* slots, bool hasError, const SemanticVM::ErrorHandler& onError,
+             SemBudgetMeter* meter = nullptr);
+
+    // 生成的机器码字节数
+    size_t codeSize() const { return size; }
+
+private:
+    void* code = nullptr;
+    size_t mapped = 0;
+    size_t size = 0;
+    std::vector<SemValue> constants;
+    int varCount = 0;
+    int frameSize = 0;          // 不含末尾的错误标志与剩余步数
+    std::vector<SemWord> frame;
+
+    void release();
+};
+
+#endif // SEMANTICJIT_H
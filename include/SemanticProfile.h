@@ -0,0 +1,51 @@
+// SemanticProfile.h
+#ifndef SEMANTICPROFILE_H
+#define SEMANTICPROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "SemanticAST.h"
+
+// 一条语句的执行统计。耗时单位为纳秒：total含内层语句，self不含
+struct SemStmtProfile {
+    int stmt = -1;                  // SemProgram::stmts中的下标
+    SemStmt::Kind kind = SemStmt::ASSIGN;
+    int line = 0;                   // 语句首个记号所在的源程序行号，从1开始
+    std::string text;               // 语句开头的几个记号，便于辨认
+    uint64_t count = 0;             // 执行次数（while语句每次进入计一次，循环体按轮计）
+    uint64_t totalNanos = 0;
+    uint64_t selfNanos = 0;
+    uint64_t taken = 0;             // IF/WHILE: 条件成立的次数
+    uint64_t notTaken = 0;          // IF/WHILE: 条件不成立的次数
+};
+
+// 一行源程序的统计：该行开始的各语句之和，耗时取自身耗时，故各行之和不重复计算
+struct SemLineProfile {
+    int line = 0;
+    uint64_t count = 0;
+    uint64_t selfNanos = 0;
+};
+
+// 一次分析的语句级剖析结果
+struct SemProfile {
+    std::vector<SemStmtProfile> stmts;  // 下标同SemProgram::stmts
+    std::vector<SemLineProfile> lines;  // 按行号排列，只含执行过的行
+    uint64_t totalNanos = 0;            // 整个复合语句部分的执行耗时
+
+    // 由stmts汇总lines
+    void collectLines();
+    // 执行过的语句按自身耗时从高到低排列（相同时按执行次数），返回stmts中的下标
+    std::vector<int> hotSpots() const;
+    // 热点表：前limit条语句与各行的统计，供人阅读
+    void printHotSpots(std::ostream& out, size_t limit = 10) const;
+    // 机器可读的JSON：{"totalNanos":..,"statements":[..],"lines":[..]}，只含执行过的语句
+    void writeJson(std::ostream& out) const;
+};
+
+// 各记号所在的行号（从1开始），记号的划分与按空白切分相同
+std::vector<int> semTokenLines(const std::string& prog);
+
+#endif // SEMANTICPROFILE_H
@@ -0,0 +1,22 @@
+// SemanticTypeCheck.h
+#ifndef SEMANTICTYPECHECK_H
+#define SEMANTICTYPECHECK_H
+
+#include <string>
+#include <vector>
+#include "SemanticAST.h"
+
+// 静态类型检查的结果，对同一语法树只需计算一次，编译与执行阶段共用
+struct SemTypeInfo {
+    std::vector<SemType> varTypes;      // 下标同SemProgram::varNames
+    std::vector<SemType> exprTypes;     // 下标同SemProgram::exprs
+    std::vector<std::string> errors;    // 按源程序顺序
+};
+
+// 不执行程序，一次线性扫描推导每个表达式的int/real类型并检查每条赋值：
+//   字面量、变量取自身类型；二元运算任一侧为real则为real，否则取左操作数的类型；
+//   real表达式赋给int变量报"realnum can not be translated into int type"。
+// 表达式结点按后序存放（子结点下标小于父结点），故按下标顺序扫描即可。
+SemTypeInfo checkSemanticTypes(const SemProgram& program, const std::vector<SemType>& varTypes);
+
+#endif // SEMANTICTYPECHECK_H
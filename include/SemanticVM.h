@@ -0,0 +1,103 @@
+// SemanticVM.h
+#ifndef SEMANTICVM_H
+#define SEMANTICVM_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "SemanticBudget.h"
+#include "SemanticIR.h"
+
+// 寄存器式字节码，由三地址码逐块线性化得到。每条指令直接以帧中的下标为操作数，
+// 帧依次存放变量（符号表槽位）、常量与临时值。操作数类型由静态类型检查确定，
+// 运行时不再检查类型标记：I前缀的指令操作64位整数，R前缀的指令操作double。
+enum SemOpcode : uint8_t {
+    // 与IROp的前11项一一对应
+    OP_COPY,        // [dst] = [a]
+    OP_I2R,         // [dst] = (double)[a]
+    OP_IADD,        // [dst] = [a] op [b]
+    OP_ISUB,
+    OP_IMUL,
+    OP_IDIV,
+    OP_RADD,
+    OP_RSUB,
+    OP_RMUL,
+    OP_RDIV,
+    OP_STORE,       // 变量[dst] = [a]，出现错误后不再生效
+    OP_JUMP,        // 跳转到dst
+    OP_BLT_I,       // 若 [a] < [b] 则跳转到dst
+    OP_BGT_I,
+    OP_BLE_I,
+    OP_BGE_I,
+    OP_BEQ_I,
+    OP_BLT_R,
+    OP_BGT_R,
+    OP_BLE_R,
+    OP_BGE_R,
+    OP_BEQ_R,
+    OP_BNLT_I,      // 若不满足 [a] < [b] 则跳转到dst
+    OP_BNGT_I,
+    OP_BNLE_I,
+    OP_BNGE_I,
+    OP_BNEQ_I,
+    OP_BNLT_R,
+    OP_BNGT_R,
+    OP_BNLE_R,
+    OP_BNGE_R,
+    OP_BNEQ_R,
+    OP_HALT,
+    OP_BUDGET,      // 计一步（放在回跳之前），预算用完或被取消时中止；已出现错误时同OP_LOOP
+    OP_LOOP,        // 放在回跳之前：已出现错误时赋值不再生效、循环无法前进，结束执行
+    OP_COUNT
+};
+
+struct SemInstr {
+    SemOpcode op;
+    int32_t dst, a, b;
+};
+
+// 帧中的一个值，int与real共用8字节
+union SemWord {
+    int64_t i;
+    double r;
+};
+
+struct SemChunk {
+    std::vector<SemInstr> code;
+    std::vector<SemValue> constants;    // 位于帧的[varCount, varCount + constants.size())
+    int varCount = 0;
+    int frameSize = 0;
+};
+
+// 把三地址码按块的顺序线性化为字节码，后继恰为下一块时省去跳转；
+// 每个回跳前插入OP_LOOP，budgetChecks为真时插入OP_BUDGET
+SemChunk compileSemanticIR(const IRFunction& fn, bool budgetChecks = false);
+
+// 字节码虚拟机。GCC/Clang下用computed goto做线程化分派，其他编译器退化为switch。
+class SemanticVM {
+public:
+    using ErrorHandler = std::function<void(const std::string&)>;
+
+    enum Mode {
+        // 运算语义（见SemanticValue.h，除零后报错并保留左值、出现错误后不再更新变量）
+        // 与逐记号解释保持一致
+        PRECISE,
+        // 执行经过优化的代码：优化假定执行中不出错，遇到除零立即放弃
+        SPECULATIVE
+    };
+
+    // slots为按符号表槽位排列的变量（SymbolTable::data()），执行结束后写回；
+    // hasError表示执行前是否已有错误。SPECULATIVE模式下放弃执行时返回false，slots不变。
+    // 字节码含OP_BUDGET时必须给出meter；预算用完或被取消时也返回false，此时meter->aborted()为真。
+    bool run(const SemChunk& chunk, SemValue* slots, Mode mode, bool hasError, const ErrorHandler& onError,
+             SemBudgetMeter* meter = nullptr);
+
+private:
+    std::vector<SemWord> frame;
+};
+
+// 反汇编，调试用
+std::string disassembleSemanticChunk(const SemChunk& chunk);
+
+#endif // SEMANTICVM_H
@@ -0,0 +1,116 @@
+// SemanticValue.h
+#ifndef SEMANTICVALUE_H
+#define SEMANTICVALUE_H
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// 值的类型标记；未声明的变量为UNTYPED，按整数表示与运算
+enum SemType : uint8_t {
+    SEM_UNTYPED = 0,
+    SEM_INT,
+    SEM_REAL
+};
+
+// 关系运算符；无法识别的运算符为REL_INVALID，条件恒为假
+enum SemRelOp : uint8_t {
+    REL_LT,
+    REL_GT,
+    REL_LE,
+    REL_GE,
+    REL_EQ,
+    REL_INVALID
+};
+
+const char* semTypeName(SemType type);
+
+// 整数字面量的值：取开头的十进制数字（如"5.73"取5）。超出int64范围时返回false，value为0
+bool semParseInt(const std::string& text, int64_t& value);
+
+// 带类型标记的值：real使用r，其余类型使用64位整数i。可平凡复制，求值过程中不分配内存
+struct SemValue {
+    SemType type;
+    union {
+        int64_t i;
+        double r;
+    };
+
+    SemValue() : type(SEM_UNTYPED), i(0) {}
+
+    static SemValue ofInt(int64_t v, SemType t = SEM_INT) {
+        SemValue x;
+        x.type = t;
+        x.i = v;
+        return x;
+    }
+    static SemValue ofReal(double v) {
+        SemValue x;
+        x.type = SEM_REAL;
+        x.r = v;
+        return x;
+    }
+
+    bool isReal() const { return type == SEM_REAL; }
+    double number() const { return isReal() ? r : (double)i; }
+    bool isZero() const { return isReal() ? r == 0.0 : i == 0; }
+};
+
+static_assert(std::is_trivially_copyable<SemValue>::value, "SemValue must be trivially copyable");
+
+// 整数运算按64位补码回绕，避免有符号溢出的未定义行为
+inline int64_t semWrapAdd(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+inline int64_t semWrapSub(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+inline int64_t semWrapMul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+inline int64_t semWrapDiv(int64_t a, int64_t b) { return (b == -1) ? semWrapSub(0, a) : a / b; }
+
+// 二元算术：任一侧为real时按double计算，结果为real；否则按整数计算，结果保持左值的类型。
+// 除数为0时不计算，由调用方报错并保留左值。
+inline SemValue semArith(char op, SemValue l, SemValue r) {
+    if (l.isReal() || r.isReal()) {
+        double a = l.number(), b = r.number();
+        switch (op) {
+        case '+': return SemValue::ofReal(a + b);
+        case '-': return SemValue::ofReal(a - b);
+        case '*': return SemValue::ofReal(a * b);
+        default: return SemValue::ofReal(a / b);
+        }
+    }
+    switch (op) {
+    case '+': return SemValue::ofInt(semWrapAdd(l.i, r.i), l.type);
+    case '-': return SemValue::ofInt(semWrapSub(l.i, r.i), l.type);
+    case '*': return SemValue::ofInt(semWrapMul(l.i, r.i), l.type);
+    default: return SemValue::ofInt(semWrapDiv(l.i, r.i), l.type);
+    }
+}
+
+// 比较：两侧均为整数时精确比较，否则按double比较
+inline bool semCompare(SemRelOp op, SemValue l, SemValue r) {
+    if (l.isReal() || r.isReal()) {
+        double a = l.number(), b = r.number();
+        switch (op) {
+        case REL_LT: return a < b;
+        case REL_GT: return a > b;
+        case REL_LE: return a <= b;
+        case REL_GE: return a >= b;
+        case REL_EQ: return a == b;
+        default: return false;
+        }
+    }
+    switch (op) {
+    case REL_LT: return l.i < r.i;
+    case REL_GT: return l.i > r.i;
+    case REL_LE: return l.i <= r.i;
+    case REL_GE: return l.i >= r.i;
+    case REL_EQ: return l.i == r.i;
+    default: return false;
+    }
+}
+
+// 按目标变量自身的类型保存值：int截断小数部分，real转换为double
+inline void semAssign(SemValue& dst, SemValue v) {
+    if (dst.isReal()) dst.r = v.number();
+    else dst.i = v.isReal() ? (int64_t)v.r : v.i;
+}
+
+#endif // SEMANTICVALUE_H
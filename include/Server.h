@@ -0,0 +1,75 @@
+// Server.h
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include "Driver.h"
+
+// 常驻服务的请求协议。请求与响应都是帧：4字节大端长度 + 内容，内容上限SERVER_MAX_FRAME。
+//   请求内容：1字节功能编号（DriverMode，1~4）+ 1字节标志 + 程序文本；
+//             标志第0位为1时按摘要格式只返回简要结果，第1位为1时返回NDJSON记录，
+//             都为0时返回与交互模式相同的完整输出
+//   响应内容：1字节状态 + 输出文本；状态0为通过，1为有词法/语法/语义错误，2为请求无效
+// 一个连接上可以依次发送任意多个请求，每个请求按顺序得到一个响应。
+const uint32_t SERVER_MAX_FRAME = 64u << 20;
+
+enum ServerStatus : uint8_t {
+    SERVER_OK = 0,
+    SERVER_ERRORS = 1,
+    SERVER_BAD_REQUEST = 2
+};
+
+std::string makeServerRequest(DriverMode mode, DriverFormat format, const std::string& code);
+// 处理一个请求内容，返回响应内容；处理中的异常以SERVER_ERRORS状态与说明返回，不向外抛出
+std::string handleServerRequest(AnalysisSession& session, const std::string& request);
+
+#ifndef _WIN32
+// 在文件描述符上读写一帧；对端关闭、出错或长度超限时返回false
+bool readServerFrame(int fd, std::string& payload);
+bool writeServerFrame(int fd, const std::string& payload);
+
+// Unix域套接字上的常驻服务。分析表在启动时构造一次，每个工作线程各有一个AnalysisSession，
+// 接受的连接排队交给空闲的工作线程，由它依次处理该连接上的全部请求，
+// 故同时服务的连接数等于线程数，其余连接等待。
+class AnalysisServer {
+public:
+    // threads为0时取硬件线程数
+    AnalysisServer(const DriverOptions& options, unsigned threads);
+    ~AnalysisServer();
+    AnalysisServer(const AnalysisServer&) = delete;
+    AnalysisServer& operator=(const AnalysisServer&) = delete;
+
+    // 在path上监听（已存在的同名套接字文件先删除）；失败时返回false并在failure中说明原因
+    bool listen(const std::string& path, std::string& failure);
+    // 接受并处理连接，直到stop()
+    void serve();
+    // 停止接受连接并断开现有连接，serve随即返回；可在其他线程调用
+    void stop();
+
+    // 监听套接字，listen成功前为-1
+    int listeningFd() const { return listenFd; }
+
+private:
+    const DriverOptions& options;
+    unsigned threadCount;
+    std::shared_ptr<const SLRTables> tables;
+    int listenFd = -1;
+    std::string socketPath;
+    std::atomic<bool> stopping{false};
+    std::mutex connectionsMutex;
+    std::unordered_set<int> connections;    // 正在服务的连接，stop时逐个断开
+
+    void serveConnection(AnalysisSession& session, int fd);
+};
+#endif
+
+// 命令行的服务模式：options.serveStdio为真时从标准输入读请求、向标准输出写响应，
+// 否则在options.serveSocket上监听。收到SIGINT/SIGTERM或标准输入结束时退出，返回进程退出码。
+int runServer(const DriverOptions& options);
+
+#endif // SERVER_H
@@ -0,0 +1,41 @@
+// SymbolTable.h
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SemanticAST.h"
+
+// 变量即带类型标记的值：int为64位整数，real为double
+typedef SemValue Var;
+
+// 符号表：变量名在声明时解析为稠密槽位，执行期只按槽位下标访问连续数组
+class SymbolTable {
+public:
+    // 声明变量，重复声明时沿用原槽位并覆盖类型；返回槽位
+    int declare(const std::string& name, SemType type);
+    // 为未声明的变量分配一个UNTYPED槽位（值为0），返回槽位
+    int declareUntyped(const std::string& name);
+    // 查找槽位，未声明时返回-1
+    int lookup(const std::string& name) const;
+
+    Var& operator[](int slot) { return vars[slot]; }
+    const Var& operator[](int slot) const { return vars[slot]; }
+    // 按名字访问，不存在时抛出std::out_of_range
+    const Var& at(const std::string& name) const;
+
+    int size() const { return (int)vars.size(); }
+    // 按槽位排列的连续数组，供虚拟机直接读写
+    Var* data() { return vars.data(); }
+    const std::string& name(int slot) const { return names[slot]; }
+    void clear();
+
+private:
+    std::unordered_map<std::string, int> slots;
+    std::vector<std::string> names;
+    std::vector<Var> vars;
+};
+
+#endif // SYMBOLTABLE_H
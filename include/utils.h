@@ -5,8 +5,12 @@
 
 
 void setConsoleEncoding();
+// 标准输入是否为终端；不是终端（管道、重定向）时不输出交互提示
+bool stdinIsTerminal();
 void readCodeFromInput(std::string& prog);
 void readCodeFromFile(std::string file_path,std::string& prog);
+// 按行读取整个文件（每行末尾补换行符），不输出任何提示；无法打开时返回false
+bool loadCodeFile(const std::string& file_path, std::string& prog);
 
 
 void LexicalFunction(std::string code);
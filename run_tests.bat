@@ -4,7 +4,7 @@ setlocal enabledelayedexpansion
 set "PROGRAM=build\bin\main.exe"
 
 echo ============================================
-echo   批量测试工具 v3.0 (修复路径问题)
+echo   批量测试工具 v4.0 (命令行参数，每种功能一个进程)
 echo ============================================
 echo.
 
@@ -13,53 +13,24 @@ dir data
 echo.
 
 echo 测试模式1: 词法分析
-for %%i in (1 2 3 4) do (
-    echo [测试 %%i] Test%%i.txt
-    REM 去掉路径的引号
-    (
-        echo 1
-        echo n
-        echo data\Test%%i.txt
-    ) | "%PROGRAM%"
-    echo ======================
-    echo.
-)
+"%PROGRAM%" --lex data\Test1.txt data\Test2.txt data\Test3.txt data\Test4.txt
+echo ======================
+echo.
 
 echo 测试模式2: LL1语法分析
-for %%i in (5 6 7 8) do (
-    echo [测试 %%i] Test%%i.txt
-    (
-        echo 2
-        echo n
-        echo data\Test%%i.txt
-    ) | "%PROGRAM%"
-    echo ======================
-    echo.
-)
+"%PROGRAM%" --ll1 data\Test5.txt data\Test6.txt data\Test7.txt data\Test8.txt
+echo ======================
+echo.
 
 echo 测试模式3: LR语法分析
-for %%i in (9 10 11 12) do (
-    echo [测试 %%i] Test%%i.txt
-    (
-        echo 3
-        echo n
-        echo data\Test%%i.txt
-    ) | "%PROGRAM%"
-    echo ======================
-    echo.
-)
+"%PROGRAM%" --slr data\Test9.txt data\Test10.txt data\Test11.txt data\Test12.txt
+echo ======================
+echo.
 
 echo 测试模式4: 语义分析
-for %%i in (13 14 15 16) do (
-    echo [测试 %%i] Test%%i.txt
-    (
-        echo 4
-        echo n
-        echo data\Test%%i.txt
-    ) | "%PROGRAM%"
-    echo ======================
-    echo.
-)
+"%PROGRAM%" --sem data\Test13.txt data\Test14.txt data\Test15.txt data\Test16.txt data\Test17.txt
+echo ======================
+echo.
 
 echo ============================================
 echo   所有测试完成
@@ -0,0 +1,668 @@
+// Driver.cpp
+#include "Driver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+
+#include "LexicalAnalyzer.h"
+#include "LL1Parser.h"
+#include "OutputSink.h"
+#include "SLRDirect.h"
+#include "utils.h"
+
+using namespace std;
+
+namespace {
+
+// 摘要格式下丢弃各分析器的完整输出
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+// 整个标准输入，与文件相同按行读取
+string readStdin() {
+    string prog, line;
+    while (getline(cin, line)) prog += line + "\n";
+    return prog;
+}
+
+// 有限的非负实数
+bool parseNumber(const char* text, double& value) {
+    char* end = nullptr;
+    value = strtod(text, &end);
+    return end != text && *end == '\0' && isfinite(value) && value >= 0;
+}
+
+// 不超过limit的十进制非负整数，不接受符号、小数与指数形式
+bool parseInteger(const string& text, uint64_t limit, uint64_t& value) {
+    const char* first = text.data();
+    const char* last = first + text.size();
+    from_chars_result r = from_chars(first, last, value);
+    return !text.empty() && text[0] != '-' && r.ec == errc() && r.ptr == last && value <= limit;
+}
+
+// 目录递归展开为其中的普通文件（按路径排序），其余输入原样保留
+bool expandInputs(const vector<string>& inputs, vector<string>& files, string& failure) {
+    for (const string& input : inputs) {
+        error_code ec;
+        if (input == "-" || !filesystem::is_directory(input, ec)) {
+            files.push_back(input);
+            continue;
+        }
+        vector<string> found;
+        filesystem::recursive_directory_iterator it(input, ec), end;
+        for (; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec)) found.push_back(it->path().string());
+        }
+        if (ec) {
+            failure = "无法读取目录 " + input + ": " + ec.message();
+            return false;
+        }
+        sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    if (files.empty()) {
+        failure = "输入的目录中没有文件";
+        return false;
+    }
+    return true;
+}
+
+// 每个工作线程一个双端队列：自己从队头取任务，取空后依次从其他线程的队尾窃取。
+// 任务在开始前全部分派，不再产生新任务，所以所有队列都空时即可结束。
+class WorkStealingQueues {
+public:
+    explicit WorkStealingQueues(size_t workers) {
+        for (size_t i = 0; i < workers; i++) lanes.emplace_back(new Lane);
+    }
+
+    void push(size_t worker, size_t task) { lanes[worker]->tasks.push_back(task); }
+
+    bool next(size_t worker, size_t& task) {
+        {
+            Lane& own = *lanes[worker];
+            lock_guard<mutex> lock(own.m);
+            if (!own.tasks.empty()) {
+                task = own.tasks.front();
+                own.tasks.pop_front();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < lanes.size(); k++) {
+            Lane& victim = *lanes[(worker + k) % lanes.size()];
+            lock_guard<mutex> lock(victim.m);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                stolen++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t steals() const { return stolen; }
+
+private:
+    struct Lane {
+        mutex m;
+        deque<size_t> tasks;
+    };
+    vector<unique_ptr<Lane>> lanes;
+    atomic<size_t> stolen{0};
+};
+
+// 一个输入的结果与统计；并行时输出先写入各线程的缓冲区，再按输入顺序输出
+struct FileResult {
+    bool loaded = false;
+    bool ok = true;
+    string out;         // 并行时缓冲的输出
+    string diag;        // 写到标准错误的部分（剖析、统计、读取失败）
+    size_t bytes = 0;
+    double millis = 0;
+};
+
+struct Totals {
+    size_t passed = 0, failed = 0, unreadable = 0;
+    size_t bytes = 0;
+    double millis = 0;
+};
+
+// code非空时为已读入的标准输入；分析输出写入out
+FileResult processFile(AnalysisSession& session, const DriverOptions& options, const string& path, const string* code,
+                       bool headers, ostream& out) {
+    FileResult result;
+    bool summary = options.format == FORMAT_SUMMARY;
+    bool ndjson = options.format == FORMAT_NDJSON;
+    string loadedCode;
+    if (path == "-") {
+        result.loaded = code != nullptr;
+    } else {
+        result.loaded = loadCodeFile(path, loadedCode);
+        code = &loadedCode;
+    }
+    if (!result.loaded) {
+        result.ok = false;
+        result.diag = "无法打开文件 " + path + "\n";
+        if (summary) out << path << '\t' << driverModeName(options.mode) << "\terror\t无法打开文件\n";
+        if (ndjson) {
+            SinkFor sink(out);
+            NdjsonRecord(*sink, "result")
+                .field("file", path)
+                .field("phase", driverModeName(options.mode))
+                .field("status", "unreadable");
+        }
+        return result;
+    }
+
+    ostringstream diag;
+    if (headers) out << "==> " << path << " <==\n";
+    if (ndjson) {
+        SinkFor sink(out);
+        NdjsonRecord(*sink, "file").field("file", path);
+    }
+    auto start = chrono::steady_clock::now();
+    string detail;
+    result.ok = session.process(options.mode, *code, options.format, out, detail);
+    result.millis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    result.bytes = code->size();
+    if (summary) {
+        out << path << '\t' << driverModeName(options.mode) << '\t' << (result.ok ? "ok" : "error");
+        if (!detail.empty()) out << '\t' << detail;
+        out << '\n';
+    }
+    if (ndjson) {
+        SinkFor sink(out);
+        NdjsonRecord record(*sink, "result");
+        record.field("file", path).field("phase", driverModeName(options.mode));
+        record.field("status", result.ok ? "ok" : "error");
+        if (!detail.empty()) record.field("detail", detail);
+        record.field("bytes", result.bytes);
+    }
+    if (options.profile && options.mode == DRIVER_SEM) session.semantic().profile().printHotSpots(diag);
+    if (options.stats) {
+        diag << path << ": " << result.bytes << " 字节, " << result.millis << " ms";
+        if (options.pipeline && options.mode == DRIVER_SLR) {
+            diag << "\n  ";
+            session.pipelineStats().print(diag);
+        }
+        diag << endl;
+    }
+    result.diag = diag.str();
+    return result;
+}
+
+// 各线程完成的结果按输入顺序输出：完成第next个输入的线程顺带输出其后已完成的连续若干个
+class OrderedOutput {
+public:
+    OrderedOutput(size_t n, OutputSink& s) : sink(s), results(n), done(n, false) {}
+
+    void complete(size_t index, FileResult result) {
+        lock_guard<mutex> lock(m);
+        results[index] = move(result);
+        done[index] = true;
+        for (; next < results.size() && done[next]; next++) {
+            FileResult& r = results[next];
+            sink << r.out;
+            if (!r.diag.empty()) {
+                // 标准输出与标准错误是同一终端时保持先后顺序
+                sink.flush();
+                cerr << r.diag << flush;
+            }
+            if (!r.loaded) sum.unreadable++;
+            else if (r.ok) sum.passed++;
+            else sum.failed++;
+            sum.bytes += r.bytes;
+            sum.millis += r.millis;
+            r = FileResult();
+        }
+    }
+
+    // 全部完成后的汇总
+    const Totals& totals() const { return sum; }
+
+private:
+    mutex m;
+    OutputSink& sink;
+    vector<FileResult> results;
+    vector<bool> done;
+    size_t next = 0;
+    Totals sum;
+};
+
+} // namespace
+
+const char* driverModeName(DriverMode mode) {
+    switch (mode) {
+    case DRIVER_LEX: return "lex";
+    case DRIVER_LL1: return "ll1";
+    case DRIVER_SLR: return "slr";
+    default: return "sem";
+    }
+}
+
+AnalysisSession::AnalysisSession(const DriverOptions& o, shared_ptr<const SLRTables> sharedTables)
+    : options(o), tables(move(sharedTables)) {
+    analyzer.setUseBytecode(options.engine != ENGINE_WALK);
+    analyzer.setUseJit(options.engine == ENGINE_JIT);
+    analyzer.setOptimize(options.optimize);
+    analyzer.setProfiling(options.profile);
+    SemBudget budget;
+    budget.maxSteps = options.maxSteps;
+    budget.maxMillis = options.maxMillis;
+    budget.maxMemory = (size_t)min<uint64_t>(options.maxMemory, SIZE_MAX);
+    analyzer.setBudget(budget);
+}
+
+bool AnalysisSession::process(DriverMode mode, const string& code, DriverFormat format, ostream& out,
+                              string& detail) {
+    detail.clear();
+    NullBuffer sink;
+    ostream discard(&sink);
+    ostream& target = format == FORMAT_SUMMARY ? discard : out;
+    try {
+        switch (mode) {
+        case DRIVER_LEX: return lex(code, format, target, detail);
+        case DRIVER_LL1: return ll1(code, format, target, detail);
+        case DRIVER_SLR: return slr(code, format, target, detail);
+        default: return sem(code, format, target, detail);
+        }
+    } catch (const exception& e) {
+        if (format == FORMAT_TEXT) out << "分析过程中出现错误: " << e.what() << '\n';
+        if (format == FORMAT_NDJSON) {
+            SinkFor records(out);
+            NdjsonRecord(*records, "diagnostic").field("phase", driverModeName(mode)).field("message", e.what());
+        }
+        detail = e.what();
+        return false;
+    }
+}
+
+// 输出格式同LexicalFunction
+bool AnalysisSession::lex(const string& code, DriverFormat format, ostream& out, string& detail) {
+    LexicalAnalysis lexer;
+    istringstream iss(code);
+    int tokenCount = lexer.analyze(iss);
+    if (format == FORMAT_TEXT) lexer.printTokens(out);
+    if (format == FORMAT_NDJSON) lexer.writeNdjson(out);
+    detail = to_string(tokenCount) + " tokens";
+    return true;
+}
+
+// 输出格式同LL1Function
+bool AnalysisSession::ll1(const string& code, DriverFormat format, ostream& out, string&) {
+    Parser parser;
+    parser.setOutput(out);
+    parser.setReportFormat(format == FORMAT_NDJSON ? REPORT_NDJSON : REPORT_TEXT);
+    bool ok = parser.parse(code);
+    if (format == FORMAT_NDJSON) parser.writeTreeNdjson();
+    if (format == FORMAT_TEXT) {
+        out << (ok ? "\n分析成功！语法树如下：" : "\n分析完成（发现语法错误）语法树如下：") << '\n';
+        out << "========================================\n";
+        parser.printSyntaxTree();
+        out << "\n\n\n 彩色语法树可视化：\n";
+        parser.drawTree();
+    }
+    return ok;
+}
+
+bool AnalysisSession::slr(const string& code, DriverFormat format, ostream& out, string& detail) {
+    if (!tables) tables = options.tableCache.empty() ? SLRTables::shared() : SLRTables::create(options.tableCache);
+    // 直接编码分析器只判断是否通过：通过时即为结果；不通过时再用表驱动分析器解析，
+    // 得到与其相同的错误行。只在摘要格式下使用，其他格式需要错误信息与推导
+    if (options.slrEngine == SLR_ENGINE_DIRECT && format == FORMAT_SUMMARY &&
+        slrDirectParse(SLRParser::tokenTypes(code), nullptr)) {
+        return true;
+    }
+    if (options.pipeline) {
+        SLRPipeline pipeline(tables);
+        pipeline.setOutput(out);
+        pipeline.setReportFormat(format == FORMAT_NDJSON ? REPORT_NDJSON : REPORT_TEXT);
+        pipeline.setRecordDerivation(format == FORMAT_TEXT);
+        bool ok = pipeline.parse(code);
+        lastPipeline = pipeline.stats();
+        if (!ok && pipeline.getErrorLine() > 0) detail = "line " + to_string(pipeline.getErrorLine());
+        return ok;
+    }
+    SLRParser parser(tables);
+    parser.setOutput(out);
+    parser.setReportFormat(format == FORMAT_NDJSON ? REPORT_NDJSON : REPORT_TEXT);
+    parser.setRecordDerivation(format == FORMAT_TEXT);
+    bool ok = parser.parse(code);
+    if (!ok && parser.getErrorLine() > 0) detail = "line " + to_string(parser.getErrorLine());
+    return ok;
+}
+
+bool AnalysisSession::sem(const string& code, DriverFormat format, ostream& out, string& detail) {
+    analyzer.analyze(code);
+    const vector<string>& errors = analyzer.errorMessages();
+    bool ok = errors.empty();
+    if (format == FORMAT_TEXT) {
+        analyzer.printResults(out);
+        if (!ok) out << '\n';  // 有错误时printResults不换行
+    }
+    if (format == FORMAT_NDJSON) analyzer.writeNdjson(out);
+    if (!ok) {
+        detail = errors.front();
+        return false;
+    }
+    // 全部变量按符号表顺序，int输出整数值，real按默认格式
+    ostringstream values;
+    const SymbolTable& symbols = analyzer.symbols();
+    for (int s = 0; s < symbols.size(); s++) {
+        if (s) values << ' ';
+        values << symbols.name(s) << '=';
+        if (symbols[s].isReal()) values << symbols[s].number();
+        else values << symbols[s].i;
+    }
+    detail = values.str();
+    return true;
+}
+
+void printDriverUsage(ostream& out) {
+    out << "用法: main [功能] [选项] <文件|目录...|->\n"
+           "不带参数时进入交互模式。目录递归处理其中的全部文件。\n"
+           "功能:\n"
+           "  --lex                词法分析\n"
+           "  --ll1                LL(1)语法分析\n"
+           "  --slr                SLR语法分析\n"
+           "  --sem                语义分析\n"
+           "选项:\n"
+           "  --format text|summary|ndjson\n"
+           "                       输出格式：完整输出（默认）、每个输入一行摘要或每行一条JSON记录\n"
+           "  --stats              在标准错误输出每个输入的耗时与汇总\n"
+           "  -o, --output 文件    结果写入文件而不是标准输出\n"
+           "  -j, --jobs 个数      并行处理的线程数，0为硬件线程数（默认1）；输出仍按输入顺序，也可写作-j4\n"
+           "  --table-cache 路径   SLR分析表缓存文件\n"
+           "  --slr-engine table|direct\n"
+           "                       SLR分析器：表驱动（默认）或构建时生成的直接编码分析器；\n"
+           "                       direct只用于--format summary，有错误的输入仍由表驱动分析器给出错误行\n"
+           "  --pipeline           SLR分析时词法、语法与输出三个阶段在各自的线程上重叠执行；\n"
+           "                       与--stats同用时输出端到端耗时与各阶段的等待时间\n"
+           "  --engine walk|vm|jit 语义分析的执行方式（默认vm）\n"
+           "  -O0                  语义分析不做优化\n"
+           "  --profile            语义分析时在标准错误输出语句热点表\n"
+           "  --max-steps 步数     语义分析的步数预算\n"
+           "  --max-millis 毫秒    语义分析的时间预算\n"
+           "  --max-memory 字节    语义分析的内存预算\n"
+           "                       服务模式下未给出时每个请求默认限时10000毫秒、内存256MB，0为不限\n"
+           "  --serve 路径         作为常驻服务在Unix域套接字上监听（协议见Server.h）\n"
+           "  --serve-stdio        作为常驻服务从标准输入读请求、向标准输出写响应\n"
+           "  --threads 个数       服务的工作线程数（默认为硬件线程数）\n"
+           "  -h, --help           显示本说明\n"
+           "退出码: 0全部通过，1有输入存在错误，2有输入无法读取或参数有误\n";
+}
+
+bool parseDriverArgs(int argc, char* argv[], DriverOptions& options, string& failure) {
+    auto setMode = [&](DriverMode mode) {
+        if (options.modeGiven && options.mode != mode) {
+            failure = "只能指定一种功能";
+            return false;
+        }
+        options.mode = mode;
+        options.modeGiven = true;
+        return true;
+    };
+
+    bool millisGiven = false, memoryGiven = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        // 带值的选项
+        auto value = [&](string& out) {
+            if (i + 1 >= argc) {
+                failure = "选项" + arg + "缺少参数";
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+
+        if (arg == "--lex") {
+            if (!setMode(DRIVER_LEX)) return false;
+        } else if (arg == "--ll1") {
+            if (!setMode(DRIVER_LL1)) return false;
+        } else if (arg == "--slr") {
+            if (!setMode(DRIVER_SLR)) return false;
+        } else if (arg == "--sem") {
+            if (!setMode(DRIVER_SEM)) return false;
+        } else if (arg == "--format") {
+            string name;
+            if (!value(name)) return false;
+            if (name == "text") options.format = FORMAT_TEXT;
+            else if (name == "summary") options.format = FORMAT_SUMMARY;
+            else if (name == "ndjson") options.format = FORMAT_NDJSON;
+            else {
+                failure = "未知的输出格式 " + name;
+                return false;
+            }
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--table-cache") {
+            if (!value(options.tableCache)) return false;
+        } else if (arg == "--slr-engine") {
+            string name;
+            if (!value(name)) return false;
+            if (name == "table") options.slrEngine = SLR_ENGINE_TABLE;
+            else if (name == "direct") options.slrEngine = SLR_ENGINE_DIRECT;
+            else {
+                failure = "未知的SLR分析器 " + name;
+                return false;
+            }
+        } else if (arg == "--pipeline") {
+            options.pipeline = true;
+        } else if (arg == "--engine") {
+            string name;
+            if (!value(name)) return false;
+            if (name == "walk") options.engine = ENGINE_WALK;
+            else if (name == "vm") options.engine = ENGINE_VM;
+            else if (name == "jit") options.engine = ENGINE_JIT;
+            else {
+                failure = "未知的执行方式 " + name;
+                return false;
+            }
+        } else if (arg == "-O0") {
+            options.optimize = false;
+        } else if (arg == "--profile") {
+            options.profile = true;
+        } else if (arg == "--max-steps") {
+            string text;
+            if (!value(text)) return false;
+            if (!parseInteger(text, UINT64_MAX, options.maxSteps)) {
+                failure = "选项--max-steps的参数应为非负整数";
+                return false;
+            }
+        } else if (arg == "--max-millis") {
+            string text;
+            if (!value(text)) return false;
+            if (!parseNumber(text.c_str(), options.maxMillis)) {
+                failure = "选项--max-millis的参数应为非负数";
+                return false;
+            }
+            millisGiven = true;
+        } else if (arg == "--max-memory") {
+            string text;
+            if (!value(text)) return false;
+            if (!parseInteger(text, UINT64_MAX, options.maxMemory)) {
+                failure = "选项--max-memory的参数应为非负整数";
+                return false;
+            }
+            memoryGiven = true;
+        } else if (arg == "-j" || arg == "--jobs" || arg.compare(0, 2, "-j") == 0) {
+            string text;
+            uint64_t number = 0;
+            // 也接受紧跟在-j后的参数，如-j4
+            bool attached = arg.size() > 2 && arg[1] == 'j';
+            if (attached) text = arg.substr(2);
+            else if (!value(text)) return false;
+            if (!parseInteger(text, UINT_MAX, number)) {
+                failure = "选项" + (attached ? string("-j") : arg) + "的参数应为非负整数";
+                return false;
+            }
+            options.jobs = (unsigned)number;
+        } else if (arg == "-o" || arg == "--output") {
+            if (!value(options.outputPath)) return false;
+        } else if (arg == "--serve") {
+            if (!value(options.serveSocket)) return false;
+        } else if (arg == "--serve-stdio") {
+            options.serveStdio = true;
+        } else if (arg == "--threads") {
+            string text;
+            uint64_t number = 0;
+            if (!value(text)) return false;
+            if (!parseInteger(text, UINT_MAX, number)) {
+                failure = "选项--threads的参数应为非负整数";
+                return false;
+            }
+            options.threads = (unsigned)number;
+        } else if (arg == "-h" || arg == "--help") {
+            options.help = true;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            failure = "未知选项 " + arg;
+            return false;
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+
+    if (options.help) return true;
+    if (options.serving()) {
+        // 服务模式下功能由每个请求指定
+        if (!options.inputs.empty()) {
+            failure = "服务模式不接受输入文件";
+            return false;
+        }
+        if (!millisGiven) options.maxMillis = SERVER_DEFAULT_MILLIS;
+        if (!memoryGiven) options.maxMemory = SERVER_DEFAULT_MEMORY;
+        return true;
+    }
+    if (!options.modeGiven) {
+        failure = "请指定功能：--lex、--ll1、--slr或--sem";
+        return false;
+    }
+    if (options.pipeline && options.mode != DRIVER_SLR) {
+        failure = "--pipeline只用于--slr";
+        return false;
+    }
+    if (options.slrEngine == SLR_ENGINE_DIRECT && (options.mode != DRIVER_SLR || options.format != FORMAT_SUMMARY)) {
+        failure = "--slr-engine direct只用于--slr --format summary";
+        return false;
+    }
+    if (options.slrEngine == SLR_ENGINE_DIRECT && options.pipeline) {
+        failure = "--slr-engine direct不能与--pipeline同用";
+        return false;
+    }
+    if (options.inputs.empty()) {
+        failure = "没有输入文件（\"-\"表示标准输入）";
+        return false;
+    }
+    return true;
+}
+
+int runDriver(const DriverOptions& options) {
+    using Clock = chrono::steady_clock;
+    auto wallStart = Clock::now();
+    vector<string> files;
+    string failure;
+    if (!expandInputs(options.inputs, files, failure)) {
+        cerr << failure << endl;
+        return 2;
+    }
+
+    // 标准输入在分派前由主线程读入
+    string stdinCode;
+    bool hasStdin = false;
+    for (const string& path : files) hasStdin = hasStdin || path == "-";
+    if (hasStdin) stdinCode = readStdin();
+
+    unsigned jobs = options.jobs ? options.jobs : max(1u, thread::hardware_concurrency());
+    jobs = (unsigned)max<size_t>(1, min<size_t>(jobs, files.size()));
+
+    // 按文件大小从大到小轮流分给各线程，各线程先做大文件，小文件留到最后供窃取
+    vector<size_t> order(files.size());
+    vector<uintmax_t> sizes(files.size(), 0);
+    for (size_t i = 0; i < files.size(); i++) {
+        order[i] = i;
+        error_code ec;
+        sizes[i] = files[i] == "-" ? stdinCode.size() : filesystem::file_size(files[i], ec);
+        if (ec) sizes[i] = 0;
+    }
+    // 单线程时按输入顺序处理，输出直接写入sink，不经缓冲
+    if (jobs > 1) stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+    WorkStealingQueues queues(jobs);
+    for (size_t k = 0; k < order.size(); k++) queues.push(k % jobs, order[k]);
+
+    shared_ptr<const SLRTables> tables;
+    if (options.mode == DRIVER_SLR) {
+        tables = options.tableCache.empty() ? SLRTables::shared() : SLRTables::create(options.tableCache);
+    }
+
+    unique_ptr<OutputSink> sink;
+    if (options.outputPath.empty()) {
+        sink.reset(new OutputSink(stdout));
+    } else if (!(sink = OutputSink::openFile(options.outputPath, failure))) {
+        cerr << failure << endl;
+        return 2;
+    }
+    ostream direct(sink.get());
+    OrderedOutput output(files.size(), *sink);
+    bool headers = options.format == FORMAT_TEXT && files.size() > 1;
+    // 同一路径的标准输入只能读一次
+    size_t firstStdin = find(files.begin(), files.end(), "-") - files.begin();
+    auto work = [&](size_t worker) {
+        AnalysisSession session(options, tables);
+        OutputSink buffer;
+        ostream buffered(&buffer);
+        size_t task;
+        while (queues.next(worker, task)) {
+            const string* code = nullptr;
+            if (files[task] == "-") code = task == firstStdin ? &stdinCode : nullptr;
+            if (jobs == 1) {
+                output.complete(task, processFile(session, options, files[task], code, headers, direct));
+            } else {
+                FileResult result = processFile(session, options, files[task], code, headers, buffered);
+                result.out = buffer.take();
+                output.complete(task, move(result));
+            }
+        }
+    };
+    if (jobs == 1) {
+        work(0);
+    } else {
+        vector<thread> workers;
+        for (unsigned w = 0; w < jobs; w++) workers.emplace_back(work, w);
+        for (thread& t : workers) t.join();
+    }
+
+    bool written = sink->flush();
+    const Totals& totals = output.totals();
+    if (options.stats) {
+        double wallMs = chrono::duration<double, milli>(Clock::now() - wallStart).count();
+        cerr << "共" << files.size() << "个输入（通过" << totals.passed << "，有错误" << totals.failed << "，无法读取"
+             << totals.unreadable << "）, " << totals.bytes << " 字节, 耗时 " << wallMs << " ms（各输入累计 "
+             << totals.millis << " ms）, " << jobs << "个线程, 窃取" << queues.steals() << "次";
+        if (wallMs > 0) cerr << ", " << totals.bytes / (wallMs / 1000) / (1 << 20) << " MiB/s";
+        cerr << endl;
+    }
+    if (!written) {
+        cerr << "写出结果失败" << endl;
+        return 2;
+    }
+    if (totals.unreadable) return 2;
+    return totals.failed ? 1 : 0;
+}
@@ -0,0 +1,202 @@
+// Grammar.cpp
+#include "Grammar.h"
+
+using namespace std;
+
+GrammarSets::GrammarSets(const Grammar& grammar)
+    : nullableSet(grammar.symbolCount()),
+      firstSets(grammar.symbolCount(), SymbolSet(grammar.symbolCount())),
+      followSets(grammar.symbolCount(), SymbolSet(grammar.symbolCount())) {
+    computeNullable(grammar);
+    computeFirst(grammar);
+    computeFollow(grammar);
+}
+
+// 先用Tarjan算法求依赖图的强连通分量，再按拓扑序逐个处理：同一分量内的集合
+// 必然相等，合并一次后整体下推给后继分量。每条边只处理一次。
+void GrammarSets::propagate(vector<SymbolSet>& sets, const vector<vector<int>>& successors) {
+    int n = (int)sets.size();
+    vector<int> index(n, -1), lowLink(n, 0), component(n, -1);
+    vector<bool> onStack(n, false);
+    vector<int> tarjanStack;
+    vector<vector<int>> components;     // Tarjan按逆拓扑序产出分量
+    int counter = 0;
+
+    // 迭代版DFS，避免长依赖链导致递归过深
+    vector<pair<int, size_t>> callStack;
+    for (int root = 0; root < n; root++) {
+        if (index[root] >= 0 || successors[root].empty()) continue;
+        callStack.push_back({ root, 0 });
+        index[root] = lowLink[root] = counter++;
+        tarjanStack.push_back(root);
+        onStack[root] = true;
+
+        while (!callStack.empty()) {
+            int v = callStack.back().first;
+            size_t& edge = callStack.back().second;
+            if (edge < successors[v].size()) {
+                int w = successors[v][edge++];
+                if (index[w] < 0) {
+                    index[w] = lowLink[w] = counter++;
+                    tarjanStack.push_back(w);
+                    onStack[w] = true;
+                    callStack.push_back({ w, 0 });
+                }
+                else if (onStack[w]) {
+                    lowLink[v] = min(lowLink[v], index[w]);
+                }
+                continue;
+            }
+
+            if (lowLink[v] == index[v]) {
+                components.emplace_back();
+                int w;
+                do {
+                    w = tarjanStack.back();
+                    tarjanStack.pop_back();
+                    onStack[w] = false;
+                    component[w] = (int)components.size() - 1;
+                    components.back().push_back(w);
+                } while (w != v);
+            }
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                int parent = callStack.back().first;
+                lowLink[parent] = min(lowLink[parent], lowLink[v]);
+            }
+        }
+    }
+
+    for (size_t c = components.size(); c-- > 0;) {
+        const vector<int>& members = components[c];
+        for (size_t i = 1; i < members.size(); i++) {
+            sets[members[0]].unionWith(sets[members[i]]);
+        }
+        for (size_t i = 1; i < members.size(); i++) {
+            sets[members[i]] = sets[members[0]];
+        }
+        for (int v : members) {
+            for (int w : successors[v]) {
+                if (component[w] != (int)c) sets[w].unionWith(sets[members[0]]);
+            }
+        }
+    }
+}
+
+// 可空性：每个产生式记录右部中尚未确认可空的符号个数，降为0时左部可空
+void GrammarSets::computeNullable(const Grammar& grammar) {
+    const auto& prods = grammar.productions;
+    vector<int> remaining(prods.size());
+    vector<vector<int>> occurrences(grammar.symbolCount());
+    vector<int> worklist;
+
+    for (size_t p = 0; p < prods.size(); p++) {
+        remaining[p] = (int)prods[p].rhs.size();
+        for (int sym : prods[p].rhs) occurrences[sym].push_back((int)p);
+        if (remaining[p] == 0 && nullableSet.insert(prods[p].lhs)) {
+            worklist.push_back(prods[p].lhs);
+        }
+    }
+
+    while (!worklist.empty()) {
+        int sym = worklist.back();
+        worklist.pop_back();
+        for (int p : occurrences[sym]) {
+            if (--remaining[p] == 0 && nullableSet.insert(prods[p].lhs)) {
+                worklist.push_back(prods[p].lhs);
+            }
+        }
+    }
+}
+
+// FIRST：A -> X1..Xn 中，X1..Xk（前k-1个可空）给出边 FIRST(Xi) ⊆ FIRST(A)
+void GrammarSets::computeFirst(const Grammar& grammar) {
+    int n = grammar.symbolCount();
+    vector<vector<int>> successors(n);
+
+    for (int sym = 0; sym < n; sym++) {
+        if (grammar.isTerminal(sym)) firstSets[sym].insert(sym);
+    }
+
+    for (const auto& prod : grammar.productions) {
+        for (int sym : prod.rhs) {
+            if (grammar.isTerminal(sym)) {
+                firstSets[prod.lhs].insert(sym);
+                break;
+            }
+            if (sym != prod.lhs) successors[sym].push_back(prod.lhs);
+            if (!nullable(sym)) break;
+        }
+    }
+
+    propagate(firstSets, successors);
+}
+
+// FOLLOW：从右向左扫描产生式，维护后缀的FIRST集与可空性；
+// 后缀可空时给出边 FOLLOW(A) ⊆ FOLLOW(Xi)
+void GrammarSets::computeFollow(const Grammar& grammar) {
+    int n = grammar.symbolCount();
+    vector<vector<int>> successors(n);
+
+    followSets[grammar.startSymbol].insert(grammar.endSymbol);
+
+    SymbolSet suffixFirst(n);
+    for (const auto& prod : grammar.productions) {
+        suffixFirst.clear();
+        bool suffixNullable = true;
+
+        for (size_t i = prod.rhs.size(); i-- > 0;) {
+            int sym = prod.rhs[i];
+            if (!grammar.isTerminal(sym)) {
+                followSets[sym].unionWith(suffixFirst);
+                if (suffixNullable && sym != prod.lhs) successors[prod.lhs].push_back(sym);
+            }
+            if (nullable(sym)) {
+                suffixFirst.unionWith(firstSets[sym]);
+            }
+            else {
+                suffixFirst = firstSets[sym];
+                suffixNullable = false;
+            }
+        }
+    }
+
+    propagate(followSets, successors);
+}
+
+bool GrammarSets::firstOfSequence(const vector<int>& seq, size_t from, SymbolSet& out) const {
+    for (size_t i = from; i < seq.size(); i++) {
+        out.unionWith(firstSets[seq[i]]);
+        if (!nullable(seq[i])) return false;
+    }
+    return true;
+}
+
+LL1Table buildLL1Table(const Grammar& grammar, const GrammarSets& sets) {
+    LL1Table table;
+    int n = grammar.symbolCount();
+    table.symbolCount = n;
+    table.entries.assign((size_t)n * n, -1);
+
+    auto place = [&](int prodId, int lhs, int terminal) {
+        int& slot = table.entries[(size_t)lhs * n + terminal];
+        if (slot >= 0 && slot != prodId) {
+            table.conflicts.push_back("M[" + to_string(lhs) + ", " + to_string(terminal) + "]: " +
+                                      to_string(slot) + " / " + to_string(prodId));
+            return;
+        }
+        slot = prodId;
+    };
+
+    for (size_t p = 0; p < grammar.productions.size(); p++) {
+        const Production& prod = grammar.productions[p];
+        SymbolSet first(n);
+        bool rhsNullable = sets.firstOfSequence(prod.rhs, 0, first);
+
+        first.forEach([&](int terminal) { place((int)p, prod.lhs, terminal); });
+        if (rhsNullable) {
+            sets.follow(prod.lhs).forEach([&](int terminal) { place((int)p, prod.lhs, terminal); });
+        }
+    }
+    return table;
+}
@@ -1,5 +1,6 @@
 // lexer_parser.cpp
 #include "LL1Parser.h"
+#include "OutputSink.h"
 #include <iostream>
 #include <stack>
 
@@ -8,9 +9,17 @@ using namespace std;
 // TreeNode 实现（在全局命名空间）
 TreeNode::TreeNode(string l, int ln) : label(l), lineNumber(ln) {}
 
+// 逐层摘下子结点再释放，被释放的结点已没有子结点，析构不递归，
+// 很深的树（如SLR分析长语句序列得到的右递归链）也不会耗尽调用栈
 TreeNode::~TreeNode() {
-    for (auto child : children) {
-        delete child;
+    vector<TreeNode*> pending;
+    pending.swap(children);
+    while (!pending.empty()) {
+        TreeNode* node = pending.back();
+        pending.pop_back();
+        pending.insert(pending.end(), node->children.begin(), node->children.end());
+        node->children.clear();
+        delete node;
     }
 }
 
@@ -202,7 +211,7 @@ int Lexer::getCurrentLine() const {
 }
 
 // Parser 实现（在全局命名空间）
-Parser::Parser() : syntaxTree(nullptr), hasError(false), tokenIndex(0), flag(true) {}
+Parser::Parser() : syntaxTree(nullptr), hasError(false), tokenIndex(0), flag(true), out(&cout), format(REPORT_TEXT) {}
 
 Parser::~Parser() {
     if (syntaxTree) {
@@ -210,35 +219,31 @@ Parser::~Parser() {
     }
 }
 
-void Parser::printTree(TreeNode* node, int depth) {
+void Parser::printTree(OutputSink& sink, TreeNode* node, int depth) {
     if (!node) return;
     
     if(flag){
         flag = false;
-        for (int i = 0; i < depth; i++) {
-            cout << "\t";
-        }
-        cout << node->label;
-        
-        for (TreeNode* child : node->children) {
-            printTree(child, depth + 1);
-        }
     } else {
-        cout << endl;
-        for (int i = 0; i < depth; i++) {
-            cout << "\t";
-        }
-        cout << node->label;
-        
-        for (TreeNode* child : node->children) {
-            printTree(child, depth + 1);
-        }
+        sink << '\n';
+    }
+    sink.repeat("\t", depth);
+    sink << node->label;
+    
+    for (TreeNode* child : node->children) {
+        printTree(sink, child, depth + 1);
     }
 }
 
 void Parser::errorRecovery(const string& message) {
     if (!hasError) {
-        cout << "语法错误,第" << lexer.getTokenLine(tokenIndex-1)-1 << "行," << message << endl;
+        int line = lexer.getTokenLine(tokenIndex-1)-1;
+        if (format == REPORT_NDJSON) {
+            SinkFor sink(*out);
+            NdjsonRecord(*sink, "diagnostic").field("phase", "ll1").field("line", line).field("message", message);
+        } else {
+            *out << "语法错误,第" << line << "行," << message << '\n';
+        }
         hasError = true;
     }
 }
@@ -551,7 +556,7 @@ TreeNode* Parser::simpleexpr() {
 }
 void Parser::drawTree() {
     if (!syntaxTree) {
-        cout << "No syntax tree available. Please parse a program first." << endl;
+        *out << "No syntax tree available. Please parse a program first.\n";
         return;
     }
     
@@ -566,10 +571,12 @@ void Parser::drawTree() {
     const string BOLD = "\033[1m";
     const string DIM = "\033[2m";
     
+    SinkFor sink(*out);
+
     // 绘制标题
-    cout << BOLD << CYAN << "\n╔══════════════════════════════════════════╗" << RESET << endl;
-    cout << BOLD << CYAN << "║        SYNTAX TREE VISUALIZATION         ║" << RESET << endl;
-    cout << BOLD << CYAN << "╚══════════════════════════════════════════╝" << RESET << endl;
+    *sink << BOLD << CYAN << "\n╔══════════════════════════════════════════╗" << RESET << '\n';
+    *sink << BOLD << CYAN << "║        SYNTAX TREE VISUALIZATION         ║" << RESET << '\n';
+    *sink << BOLD << CYAN << "╚══════════════════════════════════════════╝" << RESET << '\n';
     
     // 使用栈进行非递归遍历
     struct StackItem {
@@ -583,29 +590,29 @@ void Parser::drawTree() {
     nodeStack.push({syntaxTree, 0, initialStack});
     
     while (!nodeStack.empty()) {
-        StackItem current = nodeStack.top();
+        StackItem current = move(nodeStack.top());
         nodeStack.pop();
         
         TreeNode* node = current.node;
         int depth = current.depth;
-        vector<bool> isLastStack = current.isLastStack;
+        vector<bool>& isLastStack = current.isLastStack;
         
         // 绘制连接线
         for (int i = 0; i < depth; i++) {
             if (i < depth - 1) {
                 // 中间层：根据上层是否是最后一个兄弟节点来决定是否绘制竖线
                 if (isLastStack[i]) {
-                    cout << "    ";
+                    *sink << "    ";
                 } else {
-                    cout << "│   ";
+                    *sink << "│   ";
                 }
             } else {
                 // 当前层：连接符号
                 if (depth > 0) {
                     if (isLastStack[depth - 1]) {
-                        cout << "└── ";
+                        *sink << "└── ";
                     } else {
-                        cout << "├── ";
+                        *sink << "├── ";
                     }
                 }
             }
@@ -662,17 +669,17 @@ void Parser::drawTree() {
         
         // 打印节点
         if (depth == 0) {
-            cout << BOLD << "● " << color << label << RESET;
+            *sink << BOLD << "● " << color << label << RESET;
         } else {
-            cout << color << symbol << label << RESET;
+            *sink << color << symbol << label << RESET;
         }
         
         // 显示行号（如果有）
         if (node->lineNumber > 0) {
-            cout << DIM << " [" << node->lineNumber << "]" << RESET;
+            *sink << DIM << " [" << node->lineNumber << "]" << RESET;
         }
         
-        cout << endl;
+        *sink << '\n';
         
         // 将子节点逆序压入栈中（保证显示顺序正确）
         int childCount = node->children.size();
@@ -684,25 +691,25 @@ void Parser::drawTree() {
     }
     
     // 绘制图例
-    cout << BOLD << CYAN << "\n╔══════════════════════════════════════════╗" << RESET << endl;
-    cout << BOLD << CYAN << "║                LEGEND                    ║" << RESET << endl;
-    cout << BOLD << CYAN << "╚══════════════════════════════════════════╝" << RESET << endl;
-    
-    cout << BOLD << RED << "  ■ program       " << RESET << " - Program root node" << endl;
-    cout << BOLD << GREEN << "  ▣ stmt/compound " << RESET << " - Statement nodes" << endl;
-    cout << YELLOW << "  ◇ expression    " << RESET << " - Expression nodes" << endl;
-    cout << BLUE << "  ＠ ID           " << RESET << " - Identifier" << endl;
-    cout << MAGENTA << "  ＃ NUM          " << RESET << " - Number" << endl;
-    cout << BOLD << MAGENTA << "  ★ keyword      " << RESET << " - Keywords (if/then/else/while)" << endl;
-    cout << CYAN << "  ◆ operator     " << RESET << " - Operators (+, -, *, /, <, >, =)" << endl;
-    cout << DIM << "  ▫ separator    " << RESET << " - Separators ({, }, (, ), ;)" << endl;
-    cout << DIM << "  ε empty        " << RESET << " - Empty production (E)" << endl;
+    *sink << BOLD << CYAN << "\n╔══════════════════════════════════════════╗" << RESET << '\n';
+    *sink << BOLD << CYAN << "║                LEGEND                    ║" << RESET << '\n';
+    *sink << BOLD << CYAN << "╚══════════════════════════════════════════╝" << RESET << '\n';
+    
+    *sink << BOLD << RED << "  ■ program       " << RESET << " - Program root node" << '\n';
+    *sink << BOLD << GREEN << "  ▣ stmt/compound " << RESET << " - Statement nodes" << '\n';
+    *sink << YELLOW << "  ◇ expression    " << RESET << " - Expression nodes" << '\n';
+    *sink << BLUE << "  ＠ ID           " << RESET << " - Identifier" << '\n';
+    *sink << MAGENTA << "  ＃ NUM          " << RESET << " - Number" << '\n';
+    *sink << BOLD << MAGENTA << "  ★ keyword      " << RESET << " - Keywords (if/then/else/while)" << '\n';
+    *sink << CYAN << "  ◆ operator     " << RESET << " - Operators (+, -, *, /, <, >, =)" << '\n';
+    *sink << DIM << "  ▫ separator    " << RESET << " - Separators ({, }, (, ), ;)" << '\n';
+    *sink << DIM << "  ε empty        " << RESET << " - Empty production (E)" << '\n';
     
     // 绘制底部边框
-    cout << BOLD << CYAN << "\n════════════════════════════════════════════" << RESET << endl;
-    cout << "Total nodes: " << countNodes(syntaxTree) << endl;
-    cout << "Tree depth: " << getTreeDepth(syntaxTree) << endl;
-    cout << BOLD << CYAN << "════════════════════════════════════════════" << RESET << endl << endl;
+    *sink << BOLD << CYAN << "\n════════════════════════════════════════════" << RESET << '\n';
+    *sink << "Total nodes: " << countNodes(syntaxTree) << '\n';
+    *sink << "Tree depth: " << getTreeDepth(syntaxTree) << '\n';
+    *sink << BOLD << CYAN << "════════════════════════════════════════════" << RESET << "\n\n";
 }
 
 // 辅助函数：统计节点数量
@@ -748,7 +755,28 @@ bool Parser::parse(const string& input) {
 
 void Parser::printSyntaxTree() {
     if (syntaxTree) {
-        printTree(syntaxTree, 0);
+        SinkFor sink(*out);
+        printTree(*sink, syntaxTree, 0);
+    }
+}
+
+void Parser::writeNode(OutputSink& sink, TreeNode* node, int parent, int depth, int& nextId) {
+    int id = nextId++;
+    {
+        NdjsonRecord record(sink, "node");
+        record.field("id", id).field("parent", parent).field("depth", depth).field("label", node->label);
+        if (node->lineNumber > 0) record.field("line", node->lineNumber);
+    }
+    for (TreeNode* child : node->children) {
+        writeNode(sink, child, id, depth + 1, nextId);
+    }
+}
+
+void Parser::writeTreeNdjson() {
+    if (syntaxTree) {
+        SinkFor sink(*out);
+        int nextId = 0;
+        writeNode(*sink, syntaxTree, -1, 0, nextId);
     }
 }
 
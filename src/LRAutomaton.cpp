@@ -0,0 +1,190 @@
+// LRAutomaton.cpp
+#include "LRAutomaton.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+// 将[0, count)分给若干线程执行；任务少时直接在当前线程完成
+template<typename F>
+void parallelFor(size_t count, unsigned threads, F body) {
+    const size_t minPerThread = 8;
+    unsigned workers = (unsigned)min<size_t>(threads, (count + minPerThread - 1) / minPerThread);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; i++) body(i);
+        return;
+    }
+
+    atomic<size_t> next(0);
+    auto run = [&]() {
+        for (size_t i = next++; i < count; i = next++) body(i);
+    };
+    vector<thread> pool;
+    for (unsigned t = 1; t < workers; t++) pool.emplace_back(run);
+    run();
+    for (auto& th : pool) th.join();
+}
+
+struct KernelHash {
+    size_t operator()(const vector<LR_item>& kernel) const {
+        size_t h = kernel.size();
+        for (const auto& item : kernel) {
+            h ^= ((size_t)item.productionId * 0x9e3779b97f4a7c15ULL + item.dotPos) + (h << 6) + (h >> 2);
+        }
+        return h;
+    }
+};
+
+class AutomatonBuilder {
+public:
+    explicit AutomatonBuilder(const Grammar& g) : grammar(g), byLhs(g.symbolCount()) {
+        for (size_t p = 0; p < g.productions.size(); p++) {
+            byLhs[g.productions[p].lhs].push_back((int)p);
+        }
+    }
+
+    // LR(0)状态由核心项唯一确定；闭包只添加点在最左端的项目
+    vector<LR_item> closure(const vector<LR_item>& kernel) const {
+        vector<LR_item> items = kernel;
+        vector<bool> added(grammar.productions.size(), false);
+        for (size_t i = 0; i < items.size(); i++) {
+            const Production& prod = grammar.productions[items[i].productionId];
+            if (items[i].dotPos >= (int)prod.rhs.size()) continue;
+            int next = prod.rhs[items[i].dotPos];
+            if (grammar.isTerminal(next)) continue;
+            for (int p : byLhs[next]) {
+                if (!added[p]) {
+                    added[p] = true;
+                    items.push_back(LR_item(p, 0));
+                }
+            }
+        }
+        sort(items.begin(), items.end());
+        items.erase(unique(items.begin(), items.end()), items.end());
+        return items;
+    }
+
+    // 按符号升序给出各个goto的核心项
+    vector<pair<int, vector<LR_item>>> gotoKernels(const vector<LR_item>& items) const {
+        vector<pair<int, vector<LR_item>>> result;
+        for (const auto& item : items) {
+            const Production& prod = grammar.productions[item.productionId];
+            if (item.dotPos >= (int)prod.rhs.size()) continue;
+            int sym = prod.rhs[item.dotPos];
+            auto it = find_if(result.begin(), result.end(),
+                              [sym](const pair<int, vector<LR_item>>& g) { return g.first == sym; });
+            if (it == result.end()) {
+                result.push_back({ sym, {} });
+                it = result.end() - 1;
+            }
+            it->second.push_back(LR_item(item.productionId, item.dotPos + 1));
+        }
+        sort(result.begin(), result.end(),
+             [](const pair<int, vector<LR_item>>& a, const pair<int, vector<LR_item>>& b) { return a.first < b.first; });
+        for (auto& g : result) sort(g.second.begin(), g.second.end());
+        return result;
+    }
+
+private:
+    const Grammar& grammar;
+    vector<vector<int>> byLhs;
+};
+
+// 工作线程对一个前沿状态的扩展结果
+struct Expansion {
+    int symbol;
+    vector<LR_item> kernel;
+    int known;                   // 已存在的状态编号，-1表示新核心
+    vector<LR_item> items;       // 新核心的闭包
+};
+
+}
+
+LRAutomaton buildLR0Automaton(const Grammar& grammar, unsigned threads) {
+    AutomatonBuilder builder(grammar);
+    LRAutomaton automaton;
+    unordered_map<vector<LR_item>, int, KernelHash> stateIds;
+
+    vector<LR_item> startKernel = { LR_item(0, 0) };
+    stateIds.emplace(startKernel, 0);
+    automaton.states.push_back(builder.closure(startKernel));
+    automaton.transitions.emplace_back();
+
+    size_t levelBegin = 0;
+    while (levelBegin < automaton.states.size()) {
+        size_t levelEnd = automaton.states.size();
+        vector<vector<Expansion>> expansions(levelEnd - levelBegin);
+
+        // 并行阶段：stateIds与states只读
+        parallelFor(levelEnd - levelBegin, threads, [&](size_t k) {
+            for (auto& g : builder.gotoKernels(automaton.states[levelBegin + k])) {
+                Expansion e{ g.first, move(g.second), -1, {} };
+                auto it = stateIds.find(e.kernel);
+                if (it != stateIds.end()) e.known = it->second;
+                else e.items = builder.closure(e.kernel);
+                expansions[k].push_back(move(e));
+            }
+        });
+
+        // 合并阶段：按源状态与符号顺序编号，保证结果确定
+        for (size_t k = 0; k < expansions.size(); k++) {
+            for (auto& e : expansions[k]) {
+                int target = e.known;
+                if (target < 0) {
+                    auto inserted = stateIds.emplace(e.kernel, (int)automaton.states.size());
+                    target = inserted.first->second;
+                    if (inserted.second) {
+                        automaton.states.push_back(move(e.items));
+                        automaton.transitions.emplace_back();
+                    }
+                }
+                automaton.transitions[levelBegin + k].push_back({ e.symbol, target });
+            }
+        }
+        levelBegin = levelEnd;
+    }
+    return automaton;
+}
+
+SLRTable buildSLRTable(const Grammar& grammar, const GrammarSets& sets,
+                       const LRAutomaton& automaton, unsigned threads) {
+    SLRTable table;
+    int n = grammar.symbolCount();
+    size_t stateNum = automaton.states.size();
+    table.symbolCount = n;
+    table.action.assign(stateNum * n, encodeAction(ACT_ERROR, 0));
+    table.gotoTable.assign(stateNum * n, -1);
+
+    vector<int> rowConflicts(stateNum, 0);
+    parallelFor(stateNum, threads, [&](size_t s) {
+        int* action = &table.action[s * n];
+        int* gotoRow = &table.gotoTable[s * n];
+
+        for (const auto& t : automaton.transitions[s]) {
+            if (grammar.isTerminal(t.first)) action[t.first] = encodeAction(ACT_SHIFT, t.second);
+            else gotoRow[t.first] = t.second;
+        }
+
+        for (const auto& item : automaton.states[s]) {
+            const Production& prod = grammar.productions[item.productionId];
+            if (item.dotPos != (int)prod.rhs.size()) continue;
+
+            if (item.productionId == 0) {
+                action[grammar.endSymbol] = encodeAction(ACT_ACCEPT, 0);
+                continue;
+            }
+            sets.follow(prod.lhs).forEach([&](int sym) {
+                if (actionKind(action[sym]) != ACT_ERROR) rowConflicts[s]++;
+                action[sym] = encodeAction(ACT_REDUCE, item.productionId);
+            });
+        }
+    });
+
+    for (int c : rowConflicts) table.conflicts += c;
+    return table;
+}
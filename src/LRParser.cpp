@@ -1,15 +1,32 @@
 // LRParser.cpp
 #include "LRParser.h"
+#include "OutputSink.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
 // 辅助方法实现
-string SLRParser::symbolToString(int symbol) {
+static string defaultSymbolName(int symbol) {
     switch (symbol) {
     case TOK_LBRACE: return "{";
     case TOK_RBRACE: return "}";
@@ -52,41 +69,24 @@ string SLRParser::symbolToString(int symbol) {
     }
 }
 
-bool SLRParser::isTerminal(int symbol) {
-    return symbol >= TOK_LBRACE && symbol <= TOK_END;
+int SLRTables::symbolIndex(int symbol) {
+    if (symbol >= TOK_LBRACE && symbol <= TOK_END) return symbol;
+    if (symbol >= NT_PROGRAM && symbol <= NT_START) return TERMINAL_COUNT + symbol - NT_PROGRAM;
+    return -1;
 }
 
-bool SLRParser::isEpsilonProduction(const Production& prod) {
-    return prod.rhs.empty();
+string SLRTables::symbolToString(int symbol) const {
+    int index = symbolIndex(symbol);
+    if (index < 0 || index >= (int)symbolNames.size()) return "?";
+    return symbolNames[index];
 }
 
-// 词法分析实现
-vector<pair<int, int>> SLRParser::tokenize(const string& prog) {
-    vector<pair<int, int>> tokens;
-    istringstream iss(prog);
-    string line;
-    int lineNum = 1;
-
-    while (getline(iss, line)) {
-        if (line.empty()) continue;
-
-        istringstream lineStream(line);
-        string token;
-
-        while (lineStream >> token) {
-            int tokenType = getTokenType(token);
-            if (tokenType != -1) {
-                tokens.push_back({ tokenType, lineNum });
-            }
-        }
-
-        lineNum++;
-    }
-
-    return tokens;
+bool SLRTables::isTerminal(int symbol) {
+    return symbol >= TOK_LBRACE && symbol <= TOK_END;
 }
 
-int SLRParser::getTokenType(const string& token) {
+// 记号类型识别（供记号流与解析器共用）
+static int lookupTokenType(const string& token) {
     if (token == "{") return TOK_LBRACE;
     if (token == "}") return TOK_RBRACE;
     if (token == "if") return TOK_IF;
@@ -111,8 +111,92 @@ int SLRParser::getTokenType(const string& token) {
     return -1;
 }
 
+// 记号流实现
+// 行号只统计非空行，与按行读取后跳过空行的做法保持一致
+LRTokenStream::LRTokenStream(const string& prog)
+    : src(prog), pos(0), lineNum(1), lineHasChars(false), fetched(false), seenToken(false), cur(TOK_END, 1),
+      source(nullptr), batchPos(0), sourceDone(false) {}
+
+static const string noSource;
+
+LRTokenStream::LRTokenStream(LRTokenSource& s)
+    : src(noSource), pos(0), lineNum(1), lineHasChars(false), fetched(false), seenToken(false), cur(TOK_END, 1),
+      source(&s), batchPos(0), sourceDone(false) {}
+
+void LRTokenStream::fetch() {
+    if (source) {
+        while (batchPos == batch.size() && !sourceDone) {
+            batchPos = 0;
+            sourceDone = !source->nextBatch(batch);
+            if (sourceDone) batch.clear();
+        }
+        if (batchPos < batch.size()) {
+            cur = batch[batchPos++];
+            seenToken = true;
+        } else {
+            cur.first = TOK_END;
+        }
+        fetched = true;
+        return;
+    }
+    string token;
+    while (pos < src.size()) {
+        char c = src[pos];
+        if (c == '\n') {
+            if (lineHasChars) lineNum++;
+            lineHasChars = false;
+            pos++;
+            continue;
+        }
+        lineHasChars = true;
+        if (isspace(static_cast<unsigned char>(c))) {
+            pos++;
+            continue;
+        }
+
+        size_t start = pos;
+        while (pos < src.size() && !isspace(static_cast<unsigned char>(src[pos]))) pos++;
+        token.assign(src, start, pos - start);
+
+        int tokenType = lookupTokenType(token);
+        if (tokenType != -1) {
+            cur = { tokenType, lineNum };
+            seenToken = true;
+            fetched = true;
+            return;
+        }
+    }
+    // 输入结束：结束符沿用最后一个记号的行号
+    cur.first = TOK_END;
+    fetched = true;
+}
+
+const pair<int, int>& LRTokenStream::current() {
+    if (!pending.empty()) return pending.back();
+    if (!fetched) fetch();
+    return cur;
+}
+
+void LRTokenStream::advance() {
+    if (!pending.empty()) {
+        pending.pop_back();
+        return;
+    }
+    if (!fetched) fetch();
+    if (cur.first != TOK_END) fetched = false;
+}
+
+void LRTokenStream::insert(int token, int line) {
+    pending.push_back({ token, line });
+}
+
+bool LRTokenStream::empty() {
+    current();
+    return !seenToken;
+}
+
 // 文法初始化实现
-void SLRParser::initializeProductions() {
+void SLRTables::initializeProductions() {
     productions.push_back(Production(NT_START, { NT_PROGRAM }));
     productions.push_back(Production(NT_PROGRAM, { NT_COMPOUNDSTMT }));
     productions.push_back(Production(NT_STMT, { NT_IFSTMT }));
@@ -144,233 +228,43 @@ void SLRParser::initializeProductions() {
     productions.push_back(Production(NT_SIMPLEEXPR, { TOK_LEFT_PAREN, NT_ARITHEXPR, TOK_RIGHT_PAREN }));
 }
 
-// LR项集操作实现
-bool SLRParser::areItemSetsEqual(const set<LR_item>& set1, const set<LR_item>& set2) {
-    if (set1.size() != set2.size()) return false;
-
-    auto it1 = set1.begin();
-    auto it2 = set2.begin();
-
-    while (it1 != set1.end() && it2 != set2.end()) {
-        if (!(*it1 == *it2)) return false;
-        ++it1;
-        ++it2;
-    }
-
-    return true;
-}
-
-set<LR_item> SLRParser::closure(const set<LR_item>& items) {
-    set<LR_item> closureSet = items;
-    bool changed;
-
-    do {
-        changed = false;
-        set<LR_item> newItems = closureSet;
-
-        for (const auto& item : closureSet) {
-            const Production& prod = productions[item.productionId];
-
-            if (item.dotPos < prod.rhs.size()) {
-                int nextSymbol = prod.rhs[item.dotPos];
-
-                if (!isTerminal(nextSymbol)) {
-                    for (int i = 0; i < (int)productions.size(); i++) {
-                        if (productions[i].lhs == nextSymbol) {
-                            LR_item newItem(i, 0);
-                            if (newItems.find(newItem) == newItems.end()) {
-                                newItems.insert(newItem);
-                                changed = true;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        if (changed) {
-            closureSet = newItems;
-        }
-    } while (changed);
-
-    return closureSet;
-}
-
-set<LR_item> SLRParser::gotoFunction(const set<LR_item>& items, int symbol) {
-    set<LR_item> newItems;
-
-    for (const auto& item : items) {
-        const Production& prod = productions[item.productionId];
-
-        if (item.dotPos < prod.rhs.size() && prod.rhs[item.dotPos] == symbol) {
-            newItems.insert(LR_item(item.productionId, item.dotPos + 1));
-        }
-    }
-
-    return closure(newItems);
-}
-
 // LR(0)项集构造实现
-void SLRParser::constructLR0ItemSets() {
-    set<LR_item> initial;
-    initial.insert(LR_item(0, 0));
-    itemSets.push_back(closure(initial));
-
-    for (size_t i = 0; i < itemSets.size(); i++) {
-        for (int sym = TOK_LBRACE; sym <= NT_SIMPLEEXPR; sym++) {
-            set<LR_item> gotoSet = gotoFunction(itemSets[i], sym);
-
-            if (!gotoSet.empty()) {
-                bool found = false;
-                int foundIndex = -1;
-
-                for (size_t j = 0; j < itemSets.size(); j++) {
-                    if (areItemSetsEqual(itemSets[j], gotoSet)) {
-                        found = true;
-                        foundIndex = j;
-                        break;
-                    }
-                }
-
-                if (!found) {
-                    itemSets.push_back(gotoSet);
-                    foundIndex = itemSets.size() - 1;
-                }
-
-                if (isTerminal(sym)) {
-                    actionTable[{i, sym}] = "s" + to_string(foundIndex);
-                }
-                else {
-                    gotoTable[{i, sym}] = foundIndex;
-                }
-            }
-        }
-    }
-
-    stateCount = itemSets.size();
+LRAutomaton SLRTables::constructLR0ItemSets(const Grammar& grammar) const {
+    return buildLR0Automaton(grammar);
 }
 
-// First和Follow集计算实现
-void SLRParser::calculateFirstSets() {
-    for (int sym = TOK_LBRACE; sym <= TOK_END; sym++) {
-        firstSets[sym].insert(sym);
-    }
-
-    bool changed;
-    do {
-        changed = false;
-
-        for (size_t i = 1; i < productions.size(); i++) {
-            const Production& prod = productions[i];
-
-            if (isEpsilonProduction(prod)) {
-                if (firstSets[prod.lhs].insert(-1).second) {
-                    changed = true;
-                }
-                continue;
-            }
-
-            bool allHaveEpsilon = true;
-            for (int sym : prod.rhs) {
-                for (int firstSym : firstSets[sym]) {
-                    if (firstSym != -1) {
-                        if (firstSets[prod.lhs].insert(firstSym).second) {
-                            changed = true;
-                        }
-                    }
-                }
-
-                if (firstSets[sym].find(-1) == firstSets[sym].end()) {
-                    allHaveEpsilon = false;
-                    break;
-                }
-            }
-
-            if (allHaveEpsilon) {
-                if (firstSets[prod.lhs].insert(-1).second) {
-                    changed = true;
-                }
-            }
-        }
-    } while (changed);
-}
-
-void SLRParser::calculateFollowSets() {
-    followSets[NT_START].insert(TOK_END);
-
-    bool changed;
-    do {
-        changed = false;
-
-        for (const auto& prod : productions) {
-            for (size_t i = 0; i < prod.rhs.size(); i++) {
-                int B = prod.rhs[i];
-                if (!isTerminal(B)) {
-                    if (i == prod.rhs.size() - 1) {
-                        for (int sym : followSets[prod.lhs]) {
-                            if (followSets[B].insert(sym).second) {
-                                changed = true;
-                            }
-                        }
-                    }
-                    else {
-                        int next = prod.rhs[i + 1];
-                        bool allHaveEpsilon = true;
-
-                        for (size_t j = i + 1; j < prod.rhs.size(); j++) {
-                            int current = prod.rhs[j];
-
-                            for (int firstSym : firstSets[current]) {
-                                if (firstSym != -1) {
-                                    if (followSets[B].insert(firstSym).second) {
-                                        changed = true;
-                                    }
-                                }
-                            }
-
-                            if (firstSets[current].find(-1) == firstSets[current].end()) {
-                                allHaveEpsilon = false;
-                                break;
-                            }
-                        }
-
-                        if (allHaveEpsilon) {
-                            for (int sym : followSets[prod.lhs]) {
-                                if (followSets[B].insert(sym).second) {
-                                    changed = true;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    } while (changed);
+// 文法描述实现
+Grammar SLRTables::grammarDescription() const {
+    Grammar grammar;
+    grammar.productions = productions;
+    grammar.terminal.assign(NT_START + 1, false);
+    for (int sym = TOK_LBRACE; sym <= TOK_END; sym++) grammar.terminal[sym] = true;
+    grammar.startSymbol = NT_START;
+    grammar.endSymbol = TOK_END;
+    return grammar;
 }
 
 // SLR分析表构造实现
-void SLRParser::constructParsingTable() {
-    for (int i = 0; i < stateCount; i++) {
-        for (const auto& item : itemSets[i]) {
-            const Production& prod = productions[item.productionId];
-
-            if (item.dotPos == prod.rhs.size()) {
-                if (item.productionId == 0) {
-                    actionTable[{i, TOK_END}] = "acc";
-                }
-                else {
-                    for (int followSym : followSets[prod.lhs]) {
-                        if (followSym == -1) continue;
-                        actionTable[{i, followSym}] = "r" + to_string(item.productionId);
-                    }
-                }
-            }
+// 通用构造器按符号编号排列列，这里压缩为终结符/非终结符两张稠密表
+void SLRTables::constructParsingTable(const Grammar& grammar, const GrammarSets& sets, const LRAutomaton& automaton) {
+    SLRTable table = buildSLRTable(grammar, sets, automaton);
+    int n = table.symbolCount;
+    numStates = table.stateCount();
+
+    actionTable.assign((size_t)numStates * TERMINAL_COUNT, encodeAction(ACT_ERROR, 0));
+    gotoTable.assign((size_t)numStates * NONTERMINAL_COUNT, -1);
+    for (int i = 0; i < numStates; i++) {
+        for (int sym = TOK_LBRACE; sym <= TOK_END; sym++) {
+            actionTable[i * TERMINAL_COUNT + sym] = table.action[(size_t)i * n + sym];
+        }
+        for (int sym = NT_PROGRAM; sym <= NT_START; sym++) {
+            gotoTable[i * NONTERMINAL_COUNT + sym - NT_PROGRAM] = table.gotoTable[(size_t)i * n + sym];
         }
     }
 }
 
 // 产生式转字符串实现
-string SLRParser::productionToString(int prodId) {
+string SLRTables::productionToString(int prodId) const {
     const Production& prod = productions[prodId];
     string result = symbolToString(prod.lhs) + " ->";
 
@@ -386,26 +280,54 @@ string SLRParser::productionToString(int prodId) {
     return result;
 }
 
+// 解析事件输出实现
+SLRReportWriter::SLRReportWriter(const SLRTables& t, ostream& o, ReportFormat f, bool d)
+    : tables(t), out(o), format(f), derivation(d), steps(0) {
+    if (format == REPORT_NDJSON) records.reset(new SinkFor(out));
+}
+
+SLRReportWriter::~SLRReportWriter() {}
+
+void SLRReportWriter::reduced(int prodId) {
+    if (!records) return;
+    NdjsonRecord(**records, "reduce")
+        .field("step", ++steps)
+        .field("production", prodId)
+        .field("lhs", tables.symbolToString(tables.production(prodId).lhs))
+        .field("rule", tables.productionToString(prodId));
+}
+
+void SLRReportWriter::syntaxError(int lineNum, const string& message) {
+    if (records) {
+        NdjsonRecord(**records, "diagnostic").field("phase", "slr").field("line", lineNum).field("message", message);
+    }
+    else {
+        out << "语法错误，第" << lineNum << "行" << (message.empty() ? "" : "，" + message) << '\n';
+    }
+}
+
+void SLRReportWriter::finish(const vector<int>& reductions) {
+    if (format == REPORT_TEXT && derivation) SLRParser::printDerivation(tables, reductions, out);
+}
+
 // 错误处理实现
+// 返回true表示插入了缺失的";"，当前记号保留；否则丢弃当前记号
 bool SLRParser::handleError(int state, int token, int lineNum, 
-                           vector<pair<int, int>>& tokens, 
-                           size_t& tokenIndex, 
-                           stack<int>& stateStack, 
-                           stack<int>& symbolStack) {
+                           LRTokenStream& tokens, 
+                           vector<int>& stateStack, 
+                           vector<int>& symbolStack) {
     if (!insertedSemicolon && !hasError) {
-        if (actionTable.find({ state, TOK_SEMICOLON }) != actionTable.end()) {
-            if (tokenIndex < tokens.size()) {
-                int nextToken = tokens[tokenIndex].first;
-                if (nextToken == TOK_RBRACE || nextToken == TOK_ID ||
-                    nextToken == TOK_IF || nextToken == TOK_WHILE) {
-                    cout << "语法错误，第" << lineNum - 1 << "行，缺少\";\"" << endl;
-                    errorLine = lineNum;
-                    hasError = true;
-                    insertedSemicolon = true;
-
-                    tokens.insert(tokens.begin() + tokenIndex, make_pair(TOK_SEMICOLON, lineNum));
-                    return true;
-                }
+        if (actionKind(tables->action(state, TOK_SEMICOLON)) != ACT_ERROR) {
+            if (token == TOK_RBRACE || token == TOK_ID ||
+                token == TOK_IF || token == TOK_WHILE) {
+                // 缺少的";"属于上一行，摘要中的行号与错误信息一致
+                events->syntaxError(lineNum - 1, "缺少\";\"");
+                errorLine = lineNum - 1;
+                hasError = true;
+                insertedSemicolon = true;
+
+                tokens.insert(TOK_SEMICOLON, lineNum);
+                return true;
             }
         }
     }
@@ -416,7 +338,7 @@ bool SLRParser::handleError(int state, int token, int lineNum,
 
     vector<string> expectedSymbols;
     for (int sym = TOK_LBRACE; sym <= TOK_END; sym++) {
-        if (actionTable.find({ state, sym }) != actionTable.end()) {
+        if (actionKind(tables->action(state, sym)) != ACT_ERROR) {
             expectedSymbols.push_back(symbolToString(sym));
         }
     }
@@ -427,184 +349,608 @@ bool SLRParser::handleError(int state, int token, int lineNum,
             if (i > 0) expected += "或";
             expected += expectedSymbols[i];
         }
-        cout << "语法错误，第" << lineNum << "行，缺少\"" << expected << "\"" << endl;
+        events->syntaxError(lineNum, "缺少\"" + expected + "\"");
     }
     else {
-        cout << "语法错误，第" << lineNum << "行" << endl;
+        events->syntaxError(lineNum, "");
     }
-    tokenIndex++;
+    tokens.advance();
     return false;
 }
 
-// 字符串清理实现
-string SLRParser::cleanString(const string& str) {
-    string result;
-    bool lastWasSpace = false;
+// 解析动作处理实现
+void SLRParser::processShiftAction(int action, 
+                                  vector<int>& stateStack, 
+                                  vector<int>& symbolStack, 
+                                  vector<TreeNode*>& valueStack, 
+                                  int currentToken, 
+                                  LRTokenStream& tokens) {
+    int nextState = actionTarget(action);
+    stateStack.push_back(nextState);
+    symbolStack.push_back(currentToken);
+    if (buildTree) {
+        valueStack.push_back(new TreeNode(symbolToString(currentToken), tokens.current().second));
+    }
+    tokens.advance();
+}
 
-    for (char c : str) {
-        if (c == ' ') {
-            if (!lastWasSpace) {
-                if (!result.empty()) {
-                    result += c;
-                }
-                lastWasSpace = true;
-            }
+// 返回false表示归约后找不到GOTO项，分析栈已无法继续
+bool SLRParser::processReduceAction(int action, 
+                                   vector<int>& stateStack, 
+                                   vector<int>& symbolStack, 
+                                   vector<TreeNode*>& valueStack) {
+    int prodId = actionTarget(action);
+    const Production& prod = tables->production(prodId);
+
+    if (recordDerivation) {
+        reductions.push_back(prodId);
+    }
+    if (reportReductions) {
+        events->reduced(prodId);
+    }
+
+    if (prod.rhs.size() >= stateStack.size()) {
+        return false;
+    }
+    stateStack.resize(stateStack.size() - prod.rhs.size());
+    symbolStack.resize(symbolStack.size() - prod.rhs.size());
+
+    // 值栈：右部对应的结点出栈，挂到新建的左部结点下；空产生式挂一个"E"结点
+    if (buildTree) {
+        TreeNode* node = new TreeNode(symbolToString(prod.lhs));
+        if (prod.rhs.empty()) {
+            node->children.push_back(new TreeNode("E"));
         }
         else {
-            result += c;
-            lastWasSpace = false;
+            size_t base = valueStack.size() - prod.rhs.size();
+            node->children.assign(valueStack.begin() + base, valueStack.end());
+            valueStack.resize(base);
         }
+        valueStack.push_back(node);
     }
 
-    if (!result.empty() && result.back() == ' ') {
-        result.pop_back();
-    }
-    while (!result.empty() && result[0] == ' ') {
-        result = result.substr(1);
+    int newState = tables->gotoState(stateStack.back(), prod.lhs);
+    if (newState < 0) {
+        return false;
     }
+    stateStack.push_back(newState);
+    symbolStack.push_back(prod.lhs);
+    return true;
+}
 
+vector<string> SLRParser::getDerivation() {
+    vector<string> result;
+    result.reserve(reductions.size());
+    for (int prodId : reductions) {
+        result.push_back(tables->productionToString(prodId));
+    }
     return result;
 }
 
-// 解析动作处理实现
-void SLRParser::processShiftAction(const string& action, 
-                                  stack<int>& stateStack, 
-                                  stack<int>& symbolStack, 
-                                  int currentToken, 
-                                  size_t& tokenIndex) {
-    int nextState = stoi(action.substr(1));
-    stateStack.push(nextState);
-    symbolStack.push(currentToken);
-    tokenIndex++;
+// 打印最右推导实现
+// 从归约序列逆序重建最右推导：句型用双向链表保存，另用一个栈记录其中非终结符
+// 的位置，栈顶即最右非终结符。每步替换只花费 O(|产生式右部|)，输出经OutputSink
+// 成块写出，总耗时与输出规模成线性关系。
+void SLRParser::printDerivation(const SLRTables& tables, const vector<int>& reductions, ostream& out) {
+    if (reductions.empty()) return;
+
+    struct SymbolNode {
+        int symbol;
+        int prev;
+        int next;
+    };
+
+    vector<string> names(NT_START + 1);
+    for (int sym = 0; sym <= NT_START; sym++) {
+        names[sym] = tables.symbolToString(sym);
+    }
+
+    vector<SymbolNode> nodes;
+    vector<int> nonterminals;
+    nodes.push_back({ NT_PROGRAM, -1, -1 });
+    nonterminals.push_back(0);
+    int head = 0;
+
+    SinkFor sink(out);
+    *sink << names[NT_PROGRAM];
+
+    for (size_t i = reductions.size(); i-- > 0;) {
+        *sink << " => \n";
+
+        const Production& prod = tables.production(reductions[i]);
+
+        // 正常情况下栈顶就是待展开的非终结符；出错恢复后的序列可能不一致，此时向下查找
+        int stackPos = (int)nonterminals.size() - 1;
+        while (stackPos >= 0 && nodes[nonterminals[stackPos]].symbol != prod.lhs) stackPos--;
+
+        if (stackPos >= 0) {
+            int target = nonterminals[stackPos];
+            vector<int> newNonterminals;
+
+            if (prod.rhs.empty()) {
+                int prev = nodes[target].prev;
+                int next = nodes[target].next;
+                if (prev >= 0) nodes[prev].next = next;
+                else head = next;
+                if (next >= 0) nodes[next].prev = prev;
+            }
+            else {
+                // 复用目标结点存放右部第一个符号，其余符号依次插入其后
+                nodes[target].symbol = prod.rhs[0];
+                if (!SLRTables::isTerminal(prod.rhs[0])) newNonterminals.push_back(target);
+                int last = target;
+                for (size_t k = 1; k < prod.rhs.size(); k++) {
+                    int idx = (int)nodes.size();
+                    int next = nodes[last].next;
+                    nodes.push_back({ prod.rhs[k], last, next });
+                    nodes[last].next = idx;
+                    if (next >= 0) nodes[next].prev = idx;
+                    if (!SLRTables::isTerminal(prod.rhs[k])) newNonterminals.push_back(idx);
+                    last = idx;
+                }
+            }
+
+            nonterminals.erase(nonterminals.begin() + stackPos);
+            nonterminals.insert(nonterminals.begin() + stackPos, newNonterminals.begin(), newNonterminals.end());
+        }
+
+        for (int n = head; n >= 0; n = nodes[n].next) {
+            if (n != head) *sink << ' ';
+            *sink << names[nodes[n].symbol];
+        }
+    }
+    *sink << '\n';
 }
 
-void SLRParser::processReduceAction(const string& action, 
-                                   stack<int>& stateStack, 
-                                   stack<int>& symbolStack) {
-    int prodId = stoi(action.substr(1));
-    const Production& prod = productions[prodId];
+// 分析表二进制缓存实现
+// 文件布局（主机字节序）：
+//   magic "SLRT" | version u32 | grammarHash u64 | stateCount u32
+//   action i32[stateCount * TERMINAL_COUNT] | goto i32[stateCount * NONTERMINAL_COUNT]
+//   checksum u64（action与goto部分的FNV-1a）
+// 产生式与符号名不写入文件，加载时沿用内置文法（grammarHash已覆盖它们）。
+static const char TABLE_CACHE_MAGIC[4] = { 'S', 'L', 'R', 'T' };
+static const uint32_t TABLE_CACHE_VERSION = 2;
+
+static const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t n) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < n; i++) {
+        hash ^= p[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
 
-    rightmostDerivation.push_back(productionToString(prodId));
+// FNV-1a，覆盖缓存格式版本、表维度和全部产生式
+uint64_t SLRTables::grammarHash() const {
+    uint64_t hash = FNV_OFFSET;
+    auto mix = [&hash](int64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (uint64_t)(value >> (i * 8)) & 0xff;
+            hash *= FNV_PRIME;
+        }
+    };
+    mix(TABLE_CACHE_VERSION);
+    mix(TERMINAL_COUNT);
+    mix(NONTERMINAL_COUNT);
+    for (const auto& prod : productions) {
+        mix(prod.lhs);
+        mix((int64_t)prod.rhs.size());
+        for (int sym : prod.rhs) mix(sym);
+    }
+    return hash;
+}
 
-    if (!prod.rhs.empty()) {
-        for (size_t i = 0; i < prod.rhs.size(); i++) {
-            stateStack.pop();
-            symbolStack.pop();
+namespace {
+// 对映射内存的带边界检查的顺序读取
+struct CacheReader {
+    const char* data;
+    size_t size;
+    size_t pos;
+
+    bool read(void* out, size_t n) {
+        if (n > size - pos) return false;
+        memcpy(out, data + pos, n);
+        pos += n;
+        return true;
+    }
+    template<typename T>
+    bool readValue(T& value) { return read(&value, sizeof(T)); }
+    bool readInts(vector<int>& out, size_t count) {
+        if (count > (size - pos) / sizeof(int32_t)) return false;
+        out.resize(count);
+        return read(out.data(), count * sizeof(int32_t));
+    }
+};
+
+// 只读映射整个文件；Windows下退化为一次性读入
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    string buffer;
+#endif
+
+    bool open(const string& path) {
+#ifdef _WIN32
+        ifstream file(path, ios::binary);
+        if (!file) return false;
+        buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
         }
+        void* addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) return false;
+        data = static_cast<const char*>(addr);
+        size = (size_t)st.st_size;
+        return true;
+#endif
     }
 
-    auto gotoIt = gotoTable.find({ stateStack.top(), prod.lhs });
-    if (gotoIt != gotoTable.end()) {
-        int newState = gotoIt->second;
-        stateStack.push(newState);
-        symbolStack.push(prod.lhs);
+    ~MappedFile() {
+#ifndef _WIN32
+        if (data) munmap(const_cast<char*>(data), size);
+#endif
     }
+};
 }
 
-// 打印最右推导实现
-void SLRParser::printDerivation() {
-    if (!rightmostDerivation.empty()) {
-        string current = "program";
-        cout << current;
+// 头部匹配后仍逐项检查：移进/GOTO目标须是已有状态，归约须是已有产生式，
+// 损坏或截断的文件一律视为未命中，不会引起越界访问
+bool SLRTables::loadTables(const string& path) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    CacheReader in{ file.data, file.size, 0 };
+    char magic[4];
+    uint32_t version, stateNum;
+    uint64_t hash, checksum;
+    if (!in.read(magic, 4) || memcmp(magic, TABLE_CACHE_MAGIC, 4) != 0) return false;
+    if (!in.readValue(version) || version != TABLE_CACHE_VERSION) return false;
+    if (!in.readValue(hash) || hash != grammarHash()) return false;
+    if (!in.readValue(stateNum) || stateNum == 0 || stateNum > (uint32_t)INT32_MAX / TERMINAL_COUNT) return false;
+
+    size_t bodyStart = in.pos;
+    vector<int> loadedAction, loadedGoto;
+    if (!in.readInts(loadedAction, (size_t)stateNum * TERMINAL_COUNT)) return false;
+    if (!in.readInts(loadedGoto, (size_t)stateNum * NONTERMINAL_COUNT)) return false;
+    size_t bodyEnd = in.pos;
+    if (!in.readValue(checksum) || in.pos != in.size) return false;
+    if (checksum != fnv1a(FNV_OFFSET, in.data + bodyStart, bodyEnd - bodyStart)) return false;
+
+    for (int act : loadedAction) {
+        int target = actionTarget(act);
+        switch (actionKind(act)) {
+        case ACT_ERROR:
+        case ACT_ACCEPT:
+            if (target != 0) return false;
+            break;
+        case ACT_SHIFT:
+            if (target < 0 || target >= (int)stateNum) return false;
+            break;
+        case ACT_REDUCE:
+            if (target < 0 || target >= (int)productions.size()) return false;
+            break;
+        }
+    }
+    for (int state : loadedGoto) {
+        if (state < -1 || state >= (int)stateNum) return false;
+    }
 
-        for (int i = rightmostDerivation.size() - 1; i >= 0; i--) {
-            cout << " => " << endl;
+    actionTable.swap(loadedAction);
+    gotoTable.swap(loadedGoto);
+    initializeSymbolNames();
+    numStates = (int)stateNum;
+    return true;
+}
+
+bool SLRTables::saveTables(const string& path) const {
+    string body;
+    auto append = [&body](const void* p, size_t n) { body.append(static_cast<const char*>(p), n); };
+    uint32_t version = TABLE_CACHE_VERSION, stateNum = (uint32_t)numStates;
+    uint64_t hash = grammarHash();
+    append(TABLE_CACHE_MAGIC, 4);
+    append(&version, sizeof(version));
+    append(&hash, sizeof(hash));
+    append(&stateNum, sizeof(stateNum));
+    size_t bodyStart = body.size();
+    append(actionTable.data(), actionTable.size() * sizeof(int32_t));
+    append(gotoTable.data(), gotoTable.size() * sizeof(int32_t));
+    uint64_t checksum = fnv1a(FNV_OFFSET, body.data() + bodyStart, body.size() - bodyStart);
+    append(&checksum, sizeof(checksum));
+
+    // 先写同目录下的唯一临时文件，再改名覆盖目标：并发的进程各写各的临时文件，
+    // 读者在任何时刻看到的要么是旧缓存、要么是完整的新缓存
+#ifdef _WIN32
+    string tmpPath = path + "." + to_string(GetCurrentProcessId()) + "." + to_string(GetCurrentThreadId()) + ".tmp";
+    {
+        ofstream out(tmpPath, ios::binary | ios::trunc);
+        if (!out) return false;
+        out.write(body.data(), body.size());
+        if (!out) {
+            out.close();
+            remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (!MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+#else
+    string tmpTemplate = path + ".XXXXXX";
+    vector<char> tmpPath(tmpTemplate.begin(), tmpTemplate.end());
+    tmpPath.push_back('\0');
+    int fd = mkstemp(tmpPath.data());
+    if (fd < 0) return false;
+    bool ok = fchmod(fd, 0644) == 0;
+    for (size_t written = 0; ok && written < body.size();) {
+        ssize_t n = ::write(fd, body.data() + written, body.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        ok = n > 0;
+        if (ok) written += (size_t)n;
+    }
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || rename(tmpPath.data(), path.c_str()) != 0) {
+        unlink(tmpPath.data());
+        return false;
+    }
+    return true;
+#endif
+}
 
-            string prodStr = rightmostDerivation[i];
-            size_t arrowPos = prodStr.find("->");
-            string lhs = prodStr.substr(0, arrowPos);
-            string rhs;
+void SLRTables::initializeSymbolNames() {
+    symbolNames.clear();
+    for (int sym = TOK_LBRACE; sym <= TOK_END; sym++) symbolNames.push_back(defaultSymbolName(sym));
+    for (int sym = NT_PROGRAM; sym <= NT_START; sym++) symbolNames.push_back(defaultSymbolName(sym));
+}
 
-            if (arrowPos + 2 < prodStr.length()) {
-                rhs = prodStr.substr(arrowPos + 2);
-            }
+void SLRTables::buildTables() {
+    initializeSymbolNames();
 
-            while (!lhs.empty() && lhs.back() == ' ') lhs.pop_back();
-            while (!rhs.empty() && rhs[0] == ' ') rhs = rhs.substr(1);
+    Grammar grammar = grammarDescription();
+    GrammarSets sets(grammar);
+    LRAutomaton automaton = constructLR0ItemSets(grammar);
+    constructParsingTable(grammar, sets, automaton);
+}
 
-            size_t pos = current.rfind(lhs);
-            if (pos != string::npos) {
-                if (rhs.empty()) {
-                    current.erase(pos, lhs.length());
-                }
-                else {
-                    current.replace(pos, lhs.length(), rhs);
-                }
-            }
+// 分析表构造实现
+SLRTables::SLRTables() : numStates(0), fromCache(false) {
+    initializeProductions();
+}
 
-            current = cleanString(current);
-            cout << current;
-        }
-        cout << endl;
+shared_ptr<const SLRTables> SLRTables::create(const string& tableCachePath) {
+    shared_ptr<SLRTables> tables(new SLRTables());
+    if (!tableCachePath.empty() && tables->loadTables(tableCachePath)) {
+        tables->fromCache = true;
+        return tables;
+    }
+    tables->buildTables();
+    if (!tableCachePath.empty()) {
+        tables->saveTables(tableCachePath);
     }
+    return tables;
+}
+
+shared_ptr<const SLRTables> SLRTables::shared() {
+    static const shared_ptr<const SLRTables> instance = create();
+    return instance;
 }
 
 // 构造函数实现
-SLRParser::SLRParser() : stateCount(0), errorCount(0), hasError(false), errorLine(0), insertedSemicolon(false) {
-    initializeProductions();
-    calculateFirstSets();
-    calculateFollowSets();
-    constructLR0ItemSets();
-    constructParsingTable();
+SLRParser::SLRParser() : SLRParser(SLRTables::shared()) {}
+
+SLRParser::SLRParser(const string& tableCachePath) : SLRParser(SLRTables::create(tableCachePath)) {}
+
+SLRParser::SLRParser(shared_ptr<const SLRTables> sharedTables) : tables(move(sharedTables)), recordDerivation(true), syntaxTree(nullptr), buildTree(false), errorCount(0), hasError(false), errorLine(0), insertedSemicolon(false), out(&cout), format(REPORT_TEXT), eventSink(nullptr), events(nullptr), reportReductions(false) {}
+
+SLRParser::~SLRParser() {
+    delete syntaxTree;
 }
 
 // 解析函数实现
+// 不设步数上限，终止性由以下前进规则保证：
+//   1. 移进消耗一个记号；
+//   2. 两次移进之间的归约次数受文法限制（文法无环）；
+//   3. 错误恢复要么丢弃当前记号，要么插入一次";"（每次解析至多一次）；
+//   4. 在结束符上出错时直接停止。
 bool SLRParser::parse(const string& prog) {
-    vector<pair<int, int>> tokens = tokenize(prog);
+    LRTokenStream tokens(prog);
+    return parseTokens(tokens);
+}
+
+bool SLRParser::parse(LRTokenSource& source) {
+    LRTokenStream tokens(source);
+    return parseTokens(tokens);
+}
+
+bool SLRParser::parseTokens(LRTokenStream& tokens) {
     if (tokens.empty()) {
         return false;
     }
 
-    tokens.push_back({ TOK_END, tokens.back().second });
-    rightmostDerivation.clear();
+    reductions.clear();
+    delete syntaxTree;
+    syntaxTree = nullptr;
     hasError = false;
     insertedSemicolon = false;
     errorLine = 0;
+    SLRReportWriter writer(*tables, *out, format, recordDerivation);
+    events = eventSink ? eventSink : &writer;
+    reportReductions = eventSink || writer.wantsReductions();
 
-    stack<int> stateStack;
-    stack<int> symbolStack;
+    vector<int> stateStack;
+    vector<int> symbolStack;
 
-    stateStack.push(0);
-    symbolStack.push(TOK_END);
+    vector<TreeNode*> valueStack;
+
+    stateStack.push_back(0);
+    symbolStack.push_back(TOK_END);
 
-    size_t tokenIndex = 0;
     bool success = false;
-    int maxSteps = 1000;
-    int steps = 0;
 
-    while (!success && steps < maxSteps) {
-        steps++;
-        int currentState = stateStack.top();
-        int currentToken = tokens[tokenIndex].first;
-        int lineNum = tokens[tokenIndex].second;
+    while (!success) {
+        int currentState = stateStack.back();
+        int currentToken = tokens.current().first;
+        int lineNum = tokens.current().second;
 
-        auto actionIt = actionTable.find({ currentState, currentToken });
+        int act = tables->action(currentState, currentToken);
 
-        if (actionIt == actionTable.end()) {
-            if (handleError(currentState, currentToken, lineNum, tokens, tokenIndex, stateStack, symbolStack)) {
+        if (actionKind(act) == ACT_ERROR) {
+            if (handleError(currentState, currentToken, lineNum, tokens, stateStack, symbolStack)) {
                 continue;
             }
 
-            if (tokenIndex >= tokens.size()) {
+            if (currentToken == TOK_END) {
                 break;
             }
             continue;
         }
 
-        string action = actionIt->second;
-
-        if (action[0] == 's') {
-            processShiftAction(action, stateStack, symbolStack, currentToken, tokenIndex);
+        if (actionKind(act) == ACT_SHIFT) {
+            processShiftAction(act, stateStack, symbolStack, valueStack, currentToken, tokens);
         }
-        else if (action[0] == 'r') {
-            processReduceAction(action, stateStack, symbolStack);
+        else if (actionKind(act) == ACT_REDUCE) {
+            if (!processReduceAction(act, stateStack, symbolStack, valueStack)) {
+                hasError = true;
+                break;
+            }
         }
-        else if (action == "acc") {
+        else {
             success = true;
             break;
         }
     }
 
-    printDerivation();
+    // 接受时值栈中只剩program结点；未接受时丢弃残余的子树
+    if (success && !valueStack.empty()) {
+        syntaxTree = valueStack.back();
+        valueStack.pop_back();
+    }
+    for (TreeNode* node : valueStack) {
+        delete node;
+    }
+
+    if (!eventSink) writer.finish(reductions);
+    events = nullptr;
     return success && !hasError;
-}
\ No newline at end of file
+}
+
+
+// 记号序列与识别实现
+vector<int> SLRParser::tokenTypes(const string& prog) {
+    vector<int> result;
+    LRTokenStream tokens(prog);
+    while (tokens.current().first != TOK_END) {
+        result.push_back(tokens.current().first);
+        tokens.advance();
+    }
+    result.push_back(TOK_END);
+    return result;
+}
+
+bool SLRTables::recognize(const vector<int>& tokens, vector<int>* reductions) const {
+    vector<int> stateStack;
+    stateStack.reserve(256);
+    stateStack.push_back(0);
+    size_t pos = 0;
+
+    while (pos < tokens.size()) {
+        int act = action(stateStack.back(), tokens[pos]);
+        switch (actionKind(act)) {
+        case ACT_SHIFT:
+            stateStack.push_back(actionTarget(act));
+            pos++;
+            break;
+        case ACT_REDUCE: {
+            const Production& prod = productions[actionTarget(act)];
+            if (reductions) reductions->push_back(actionTarget(act));
+            // 表有误（如损坏的缓存）时状态栈可能不够弹出，按不接受处理
+            if (stateStack.size() <= prod.rhs.size()) return false;
+            stateStack.resize(stateStack.size() - prod.rhs.size());
+            int next = gotoState(stateStack.back(), prod.lhs);
+            if (next < 0) return false;
+            stateStack.push_back(next);
+            break;
+        }
+        case ACT_ACCEPT:
+            return true;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+// 直接编码分析器生成实现
+// 生成的函数与recognize约定相同；状态栈只在归约后回查GOTO时使用
+void SLRTables::generateDirectCode(ostream& out) const {
+    out << "// SLRDirect.cpp\n"
+        << "// 由slr_codegen根据SLRParser的分析表自动生成，请勿手工修改\n"
+        << "#include \"SLRDirect.h\"\n\n"
+        << "const int SLR_DIRECT_STATE_COUNT = " << numStates << ";\n\n"
+        << "bool slrDirectParse(const std::vector<int>& tokens, std::vector<int>* reductions) {\n"
+        << "    std::vector<int> stack;\n"
+        << "    stack.reserve(256);\n"
+        << "    const int* tok = tokens.data();\n"
+        << "    if (tokens.empty() || tokens.back() != " << TOK_END << ") return false;\n"
+        << "    goto S0;\n";
+
+    // 每个非终结符一个GOTO分派块：按归约后暴露的栈顶状态跳转
+    for (int nt = NT_PROGRAM; nt <= NT_START; nt++) {
+        bool any = false;
+        for (int s = 0; s < numStates; s++) any = any || gotoState(s, nt) >= 0;
+        if (!any) continue;
+
+        out << "\nG" << nt << ":\n"
+            << "    switch (stack.back()) {\n";
+        for (int s = 0; s < numStates; s++) {
+            int target = gotoState(s, nt);
+            if (target >= 0) out << "    case " << s << ": goto S" << target << ";\n";
+        }
+        out << "    default: return false;\n"
+            << "    }\n";
+    }
+
+    for (int s = 0; s < numStates; s++) {
+        out << "\nS" << s << ":\n"
+            << "    stack.push_back(" << s << ");\n"
+            << "    switch (*tok) {\n";
+        for (int t = TOK_LBRACE; t <= TOK_END; t++) {
+            int act = action(s, t);
+            switch (actionKind(act)) {
+            case ACT_SHIFT:
+                out << "    case " << t << ": ++tok; goto S" << actionTarget(act) << ";\n";
+                break;
+            case ACT_REDUCE: {
+                int prodId = actionTarget(act);
+                const Production& prod = productions[prodId];
+                out << "    case " << t << ":";
+                if (!prod.rhs.empty()) out << " stack.resize(stack.size() - " << prod.rhs.size() << ");";
+                out << " if (reductions) reductions->push_back(" << prodId << "); goto G" << prod.lhs << ";\n";
+                break;
+            }
+            case ACT_ACCEPT:
+                out << "    case " << t << ": return true;\n";
+                break;
+            default:
+                break;
+            }
+        }
+        out << "    default: return false;\n"
+            << "    }\n";
+    }
+    out << "}\n";
+}
@@ -1,5 +1,6 @@
 // src/LexicalAnalyzer.cpp
 #include "LexicalAnalyzer.h"
+#include "OutputSink.h"
 #include <cstdio>
 #include <cstring>
 #include <iostream>
@@ -200,6 +201,23 @@ std::vector<Token> LexicalAnalysis::getTokens() const {
     return lexical_analysis;
 }
 
+void LexicalAnalysis::printTokens(ostream& out) const {
+    SinkFor sink(out);
+    *sink << "\n分析结果 (" << lexical_analysis.size() << "个词法单元):\n";
+    for (size_t i = 0; i < lexical_analysis.size(); ++i) {
+        const Token& token = lexical_analysis[i];
+        *sink << i + 1 << ": <" << token.key << ", " << token.value << ">\n";
+    }
+}
+
+void LexicalAnalysis::writeNdjson(ostream& out) const {
+    SinkFor sink(out);
+    for (size_t i = 0; i < lexical_analysis.size(); ++i) {
+        const Token& token = lexical_analysis[i];
+        NdjsonRecord(*sink, "token").field("index", i + 1).field("key", token.key).field("value", token.value);
+    }
+}
+
 void LexicalAnalysis::clear() {
     lexical_analysis.clear();
 }
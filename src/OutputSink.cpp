@@ -0,0 +1,261 @@
+// OutputSink.cpp
+#include "OutputSink.h"
+
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+const size_t INITIAL_MEMORY = 4096;
+const size_t NUMBER_ROOM = 32;  // 64位整数或%g格式的double不超过32字节
+}
+
+OutputSink::OutputSink() : target(TARGET_MEMORY), buffer(INITIAL_MEMORY, '\0') { reset(0); }
+
+OutputSink::OutputSink(int f, size_t capacity) : target(TARGET_FD), fd(f), buffer(max(capacity, NUMBER_ROOM), '\0') {
+    reset(0);
+}
+
+OutputSink::OutputSink(FILE* f, size_t capacity)
+    : target(TARGET_FILE), file(f), buffer(max(capacity, NUMBER_ROOM), '\0') {
+    reset(0);
+}
+
+OutputSink::OutputSink(streambuf* t, size_t capacity)
+    : target(TARGET_STREAMBUF), forward(t), buffer(max(capacity, NUMBER_ROOM), '\0') {
+    reset(0);
+}
+
+OutputSink::~OutputSink() {
+    flush();
+    if (ownsFile) fclose(file);
+}
+
+unique_ptr<OutputSink> OutputSink::openFile(const string& path, string& failure) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        failure = "无法写入文件 " + path + ": " + strerror(errno);
+        return nullptr;
+    }
+    unique_ptr<OutputSink> sink(new OutputSink(f));
+    sink->ownsFile = true;
+    return sink;
+}
+
+void OutputSink::reset(size_t used) {
+    char* base = &buffer[0];
+    setp(base, base + buffer.size());
+    bump(used);
+}
+
+// pbump只接受int，超过2GB的内存输出分几次移动
+void OutputSink::bump(size_t n) {
+    while (n > (size_t)INT_MAX) {
+        pbump(INT_MAX);
+        n -= INT_MAX;
+    }
+    pbump((int)n);
+}
+
+bool OutputSink::emit(const char* p, size_t n) {
+    if (error || n == 0) return !error;
+    switch (target) {
+    case TARGET_FD:
+        while (n > 0) {
+#ifdef _WIN32
+            int put = _write(fd, p, (unsigned)min(n, (size_t)INT_MAX));
+#else
+            ssize_t put = ::write(fd, p, n);
+            if (put < 0 && errno == EINTR) continue;
+#endif
+            if (put <= 0) {
+                error = true;
+                return false;
+            }
+            p += put;
+            n -= (size_t)put;
+        }
+        break;
+    case TARGET_FILE:
+        error = fwrite(p, 1, n, file) != n;
+        break;
+    case TARGET_STREAMBUF:
+        error = forward->sputn(p, (streamsize)n) != (streamsize)n;
+        break;
+    default:
+        break;
+    }
+    return !error;
+}
+
+bool OutputSink::flush() {
+    if (target == TARGET_MEMORY) return true;
+    emit(pbase(), (size_t)(pptr() - pbase()));
+    reset(0);
+    if (!error && target == TARGET_FILE) error = fflush(file) != 0;
+    if (!error && target == TARGET_STREAMBUF) error = forward->pubsync() != 0;
+    return !error;
+}
+
+char* OutputSink::reserve(size_t n) {
+    if ((size_t)(epptr() - pptr()) >= n) return pptr();
+    if (target == TARGET_MEMORY) {
+        size_t used = (size_t)(pptr() - pbase());
+        buffer.resize(max(buffer.size() * 2, used + n));
+        reset(used);
+    } else {
+        emit(pbase(), (size_t)(pptr() - pbase()));
+        reset(0);
+    }
+    return pptr();
+}
+
+OutputSink& OutputSink::write(const char* p, size_t n) {
+    if ((size_t)(epptr() - pptr()) >= n) {
+        memcpy(pptr(), p, n);
+        bump(n);
+        return *this;
+    }
+    // 外部目标上的大块数据不经缓冲区，直接写出
+    if (target != TARGET_MEMORY && n >= buffer.size()) {
+        emit(pbase(), (size_t)(pptr() - pbase()));
+        reset(0);
+        emit(p, n);
+        return *this;
+    }
+    memcpy(reserve(n), p, n);
+    bump(n);
+    return *this;
+}
+
+OutputSink& OutputSink::operator<<(char c) {
+    *reserve(1) = c;
+    bump(1);
+    return *this;
+}
+
+OutputSink& OutputSink::operator<<(long long v) {
+    char* p = reserve(NUMBER_ROOM);
+    bump((size_t)(to_chars(p, p + NUMBER_ROOM, v).ptr - p));
+    return *this;
+}
+
+OutputSink& OutputSink::operator<<(unsigned long long v) {
+    char* p = reserve(NUMBER_ROOM);
+    bump((size_t)(to_chars(p, p + NUMBER_ROOM, v).ptr - p));
+    return *this;
+}
+
+OutputSink& OutputSink::operator<<(double v) {
+    char* p = reserve(NUMBER_ROOM);
+    bump((size_t)(to_chars(p, p + NUMBER_ROOM, v, chars_format::general, 6).ptr - p));
+    return *this;
+}
+
+OutputSink& OutputSink::repeat(string_view s, size_t n) {
+    for (size_t i = 0; i < n; i++) write(s.data(), s.size());
+    return *this;
+}
+
+OutputSink& OutputSink::exact(double v) {
+    if (v != v || v - v != 0) return write("null", 4);
+    char* p = reserve(NUMBER_ROOM);
+    bump((size_t)(to_chars(p, p + NUMBER_ROOM, v).ptr - p));
+    return *this;
+}
+
+OutputSink& OutputSink::jsonString(string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    *this << '"';
+    size_t start = 0;
+    for (size_t i = 0; i < s.size(); i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c != '"' && c != '\\' && c >= 0x20) continue;
+        write(s.data() + start, i - start);
+        start = i + 1;
+        if (c == '"' || c == '\\') {
+            *this << '\\' << (char)c;
+        } else if (c == '\n') {
+            *this << "\\n";
+        } else if (c == '\t') {
+            *this << "\\t";
+        } else {
+            *this << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+        }
+    }
+    write(s.data() + start, s.size() - start);
+    return *this << '"';
+}
+
+string OutputSink::take() {
+    size_t used = (size_t)(pptr() - pbase());
+    if (target != TARGET_MEMORY) {
+        string copy(pbase(), used);
+        reset(0);
+        return copy;
+    }
+    buffer.resize(used);
+    string result = move(buffer);
+    buffer.assign(INITIAL_MEMORY, '\0');
+    reset(0);
+    return result;
+}
+
+OutputSink* OutputSink::of(ostream& out) { return dynamic_cast<OutputSink*>(out.rdbuf()); }
+
+OutputSink::int_type OutputSink::overflow(int_type ch) {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+    *reserve(1) = traits_type::to_char_type(ch);
+    bump(1);
+    return error ? traits_type::eof() : ch;
+}
+
+streamsize OutputSink::xsputn(const char* s, streamsize n) {
+    write(s, (size_t)n);
+    return error ? 0 : n;
+}
+
+SinkFor::SinkFor(ostream& out) : sink(OutputSink::of(out)) {
+    if (!sink) {
+        own.reset(new OutputSink(out.rdbuf(), 1 << 16));
+        sink = own.get();
+    }
+}
+
+NdjsonRecord::NdjsonRecord(OutputSink& s, string_view record) : sink(s) {
+    sink << "{\"record\":";
+    sink.jsonString(record);
+}
+
+void NdjsonRecord::name(string_view key) {
+    sink << ',';
+    sink.jsonString(key);
+    sink << ':';
+}
+
+NdjsonRecord& NdjsonRecord::field(string_view key, string_view value) {
+    name(key);
+    sink.jsonString(value);
+    return *this;
+}
+
+NdjsonRecord& NdjsonRecord::field(string_view key, bool value) {
+    name(key);
+    sink << (value ? "true" : "false");
+    return *this;
+}
+
+NdjsonRecord& NdjsonRecord::field(string_view key, double value) {
+    name(key);
+    sink.exact(value);
+    return *this;
+}
@@ -0,0 +1,185 @@
+// SLRPipeline.cpp
+#include "SLRPipeline.h"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+typedef vector<pair<int, int>> TokenBatch;
+
+// 解析事件：prodId >= 0为归约，否则为第line行的语法错误
+struct SLREvent {
+    int prodId;
+    int line;
+    string message;
+};
+typedef vector<SLREvent> EventBatch;
+
+// 语法线程从记号队列取批次
+class RingTokenSource : public LRTokenSource {
+public:
+    RingTokenSource(SpscRing<TokenBatch>& r, long long& stall) : ring(r), stallNanos(stall) {}
+
+    bool nextBatch(TokenBatch& batch) override { return ring.pop(batch, stallNanos); }
+
+private:
+    SpscRing<TokenBatch>& ring;
+    long long& stallNanos;
+};
+
+// 语法线程把事件攒成批次送入事件队列
+class RingEventSink : public SLREventSink {
+public:
+    RingEventSink(SpscRing<EventBatch>& r, size_t size, long long& stall, size_t& count)
+        : ring(r), batchSize(size), stallNanos(stall), batches(count) {
+        batch.reserve(batchSize);
+    }
+
+    void reduced(int prodId) override { add(SLREvent{ prodId, 0, string() }); }
+    void syntaxError(int lineNum, const string& message) override { add(SLREvent{ -1, lineNum, message }); }
+
+    // 送出不足一批的剩余事件
+    void flush() {
+        if (batch.empty()) return;
+        batches++;
+        ring.push(batch, stallNanos);
+        batch.clear();
+        batch.reserve(batchSize);
+    }
+
+private:
+    void add(SLREvent&& event) {
+        batch.push_back(move(event));
+        if (batch.size() >= batchSize) flush();
+    }
+
+    SpscRing<EventBatch>& ring;
+    size_t batchSize;
+    long long& stallNanos;
+    size_t& batches;
+    EventBatch batch;
+};
+
+double nanosToMillis(long long ns) { return ns / 1e6; }
+
+} // namespace
+
+void SLRPipelineStats::print(ostream& out) const {
+    out << "流水线: " << tokens << "个记号（" << tokenBatches << "批）, " << eventBatches << "批事件, 端到端 "
+        << totalMillis << " ms; 等待: 词法->队列 " << lexOutputStall << " ms, 语法<-记号 " << parseInputStall
+        << " ms, 语法->队列 " << parseOutputStall << " ms, 输出<-事件 " << reportInputStall << " ms";
+}
+
+SLRPipeline::SLRPipeline(shared_ptr<const SLRTables> sharedTables)
+    : tables(move(sharedTables)), out(&cout), format(REPORT_TEXT), recordDerivation(true), batchSize(1024),
+      queueCapacity(64), errorLine(0) {}
+
+// 三个阶段：
+//   1. 词法线程用LRTokenStream切分记号，每batchSize个一批送入记号队列；
+//   2. 语法线程上的SLRParser从记号队列读取，归约与错误经RingEventSink成批送入事件队列；
+//   3. 调用线程把事件交给SLRReportWriter输出，文本格式时同时收集归约，结束后打印最右推导。
+// 批次按值移动进出队列，批内元素不复制。
+bool SLRPipeline::parse(const string& prog) {
+    auto start = chrono::steady_clock::now();
+    SpscRing<TokenBatch> tokenRing(queueCapacity);
+    SpscRing<EventBatch> eventRing(queueCapacity);
+    long long lexOut = 0, parseIn = 0, parseOut = 0, reportIn = 0;
+    size_t tokenCount = 0, tokenBatches = 0, eventBatches = 0;
+    exception_ptr lexFailure, parseFailure, reportFailure;
+    bool success = false;
+    int parsedErrorLine = 0;
+
+    auto fail = [&]() {
+        tokenRing.abort();
+        eventRing.abort();
+    };
+
+    thread lexer([&]() {
+        try {
+            LRTokenStream tokens(prog);
+            TokenBatch batch;
+            batch.reserve(batchSize);
+            for (;;) {
+                const pair<int, int>& token = tokens.current();
+                if (token.first == TOK_END) break;
+                batch.push_back(token);
+                tokens.advance();
+                if (batch.size() >= batchSize) {
+                    tokenCount += batch.size();
+                    tokenBatches++;
+                    if (!tokenRing.push(batch, lexOut)) break;
+                    batch.clear();
+                    batch.reserve(batchSize);
+                }
+            }
+            if (!batch.empty()) {
+                tokenCount += batch.size();
+                tokenBatches++;
+                tokenRing.push(batch, lexOut);
+            }
+        } catch (...) {
+            lexFailure = current_exception();
+            fail();
+        }
+        tokenRing.close();
+    });
+
+    thread parser([&]() {
+        try {
+            SLRParser slr(tables);
+            slr.setRecordDerivation(false);
+            RingTokenSource source(tokenRing, parseIn);
+            RingEventSink events(eventRing, batchSize, parseOut, eventBatches);
+            slr.setEventSink(&events);
+            success = slr.parse(source);
+            parsedErrorLine = slr.getErrorLine();
+            events.flush();
+        } catch (...) {
+            parseFailure = current_exception();
+            fail();
+        }
+        eventRing.close();
+    });
+
+    try {
+        SLRReportWriter writer(*tables, *out, format, recordDerivation);
+        bool collect = recordDerivation && format == REPORT_TEXT;
+        vector<int> reductions;
+        EventBatch batch;
+        while (eventRing.pop(batch, reportIn)) {
+            for (const SLREvent& event : batch) {
+                if (event.prodId < 0) {
+                    writer.syntaxError(event.line, event.message);
+                    continue;
+                }
+                if (collect) reductions.push_back(event.prodId);
+                if (writer.wantsReductions()) writer.reduced(event.prodId);
+            }
+        }
+        writer.finish(reductions);
+    } catch (...) {
+        reportFailure = current_exception();
+        fail();
+    }
+    lexer.join();
+    parser.join();
+
+    lastStats = SLRPipelineStats();
+    lastStats.totalMillis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    lastStats.lexOutputStall = nanosToMillis(lexOut);
+    lastStats.parseInputStall = nanosToMillis(parseIn);
+    lastStats.parseOutputStall = nanosToMillis(parseOut);
+    lastStats.reportInputStall = nanosToMillis(reportIn);
+    lastStats.tokens = tokenCount;
+    lastStats.tokenBatches = tokenBatches;
+    lastStats.eventBatches = eventBatches;
+    errorLine = parsedErrorLine;
+
+    if (lexFailure) rethrow_exception(lexFailure);
+    if (parseFailure) rethrow_exception(parseFailure);
+    if (reportFailure) rethrow_exception(reportFailure);
+    return success;
+}
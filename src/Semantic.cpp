@@ -1,14 +1,31 @@
 // Semantic.cpp
 #include "Semantic.h"
+#include "OutputSink.h"
+#include "SemanticCodegen.h"
+#include "SemanticIR.h"
+#include "SemanticJIT.h"
+#include "SemanticTypeCheck.h"
+#include "SemanticVM.h"
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 
 using namespace std;
 
 // 构造函数
-SemanticAnalyzer::SemanticAnalyzer() : posi(0), flag(false) {}
+SemanticAnalyzer::SemanticAnalyzer()
+    : posi(0), flag(false), useBytecode(true), optimize(true), useJit(false), profiling(false),
+      cancelToken(nullptr), childNanos(0) {}
 
 // 工具函数实现
+// 每条错误信息计入内存预算，超出预算后不再记录（中止原因由analyze最后用record补上）
 void SemanticAnalyzer::error(const string& msg) {
+    static const size_t prefix = sizeof("error message:line 1,") - 1;
+    if (!meter.charge(sizeof(string) + prefix + msg.size())) return;
+    record(msg);
+}
+
+void SemanticAnalyzer::record(const string& msg) {
     if (!flag) {
         errors.push_back("error message:line 1," + msg);
         flag = true;
@@ -17,12 +34,15 @@ void SemanticAnalyzer::error(const string& msg) {
     }
 }
 
-string SemanticAnalyzer::peek() {
-    return posi < tokens.size() ? tokens[posi] : "";
+// 返回引用，避免每次取记号都复制字符串
+const string& SemanticAnalyzer::peek() {
+    static const string empty;
+    return posi < (int)tokens.size() ? tokens[posi] : empty;
 }
 
-string SemanticAnalyzer::get() {
-    return posi < tokens.size() ? tokens[posi++] : "";
+const string& SemanticAnalyzer::get() {
+    static const string empty;
+    return posi < (int)tokens.size() ? tokens[posi++] : empty;
 }
 
 bool SemanticAnalyzer::isID(const string& s) {
@@ -45,99 +65,124 @@ bool SemanticAnalyzer::isReal(const string& s) {
 }
 
 // 表达式函数实现
-pair<string, double> SemanticAnalyzer::simpleexpr() {
-    string t = peek();
+SemValue SemanticAnalyzer::simpleexpr() {
+    const string& t = peek();
 
     if (isID(t)) {
+        SemValue v = symtab[slotAt(posi)];
         get();
-        return {symtab[t].type, symtab[t].value};
+        return v;
     }
     if (isInt(t)) {
-        get();
-        return {"int", stod(t)};
+        int64_t n;
+        if (!semParseInt(get(), n)) error("integer literal out of range");
+        return SemValue::ofInt(n);
     }
     if (isReal(t)) {
-        get();
-        return {"real", stod(t)};
+        return SemValue::ofReal(strtod(get().c_str(), nullptr));
     }
     if (t == "(") {
         get();
-        auto v = arithexpr();
+        SemValue v = arithexpr();
         get(); // )
         return v;
     }
     error("invalid expression");
-    return {};
+    return SemValue();
 }
 
-pair<string, double> SemanticAnalyzer::multexpr() {
-    auto l = simpleexpr();
+SemValue SemanticAnalyzer::multexpr() {
+    SemValue l = simpleexpr();
     while (peek() == "*" || peek() == "/") {
-        string op = get();
-        auto r = simpleexpr();
+        char op = get()[0];
+        SemValue r = simpleexpr();
         
-        // 除零检查
-        if (op == "/" && r.second == 0.0) {
+        // 除零检查：报错并保留左值，类型仍按静态规则提升
+        if (op == '/' && r.isZero()) {
             error("division by zero");
-            // 继续解析但不计算
+            if (r.isReal() && !l.isReal()) l = SemValue::ofReal(l.number());
             continue;
         }
-        
-        if (l.first == "real" || r.first == "real") {
-            l.first = "real";
-            if (op == "*") {
-                l.second = l.second * r.second;
-            } else if (op == "/" && r.second != 0.0) {
-                l.second = l.second / r.second;
-            }
-        } else {
-            if (op == "*") {
-                l.second = (int)l.second * (int)r.second;
-            } else if (op == "/" && r.second != 0.0) {
-                l.second = (int)l.second / (int)r.second;
-            }
-        }
+        l = semArith(op, l, r);
     }
     return l;
 }
 
-pair<string, double> SemanticAnalyzer::arithexpr() {
-    auto l = multexpr();
+SemValue SemanticAnalyzer::arithexpr() {
+    SemValue l = multexpr();
     while (peek() == "+" || peek() == "-") {
-        string op = get();
-        auto r = multexpr();
-        if (l.first == "real" || r.first == "real") {
-            l.first = "real";
-            l.second = (op == "+") ? l.second + r.second : l.second - r.second;
-        } else {
-            l.second = (op == "+") ? (int)l.second + (int)r.second
-                                   : (int)l.second - (int)r.second;
-        }
+        char op = get()[0];
+        SemValue r = multexpr();
+        l = semArith(op, l, r);
     }
     return l;
 }
 
 bool SemanticAnalyzer::boolexpr() {
-    auto l = arithexpr();
-    string op = get();
-    auto r = arithexpr();
-
-    if (op == "<")  return l.second <  r.second;
-    if (op == ">")  return l.second >  r.second;
-    if (op == "<=") return l.second <= r.second;
-    if (op == ">=") return l.second >= r.second;
-    if (op == "==") return l.second == r.second;
+    SemValue l = arithexpr();
+    const string& op = get();
+    SemValue r = arithexpr();
+
+    if (op == "<")  return semCompare(REL_LT, l, r);
+    if (op == ">")  return semCompare(REL_GT, l, r);
+    if (op == "<=") return semCompare(REL_LE, l, r);
+    if (op == ">=") return semCompare(REL_GE, l, r);
+    if (op == "==") return semCompare(REL_EQ, l, r);
     error("invalid boolop");
     return false;
 }
 
 // 语句函数实现
+// 不执行的语句按预先登记的结束位置整体跳过，不再逐记号解释
 void SemanticAnalyzer::stmt(bool execute) {
+    // 中止后其余语句都不执行
+    if (meter.aborted()) execute = false;
+    if (!execute && posi < (int)stmtEnds.size() && stmtEnds[posi] >= 0) {
+        posi = stmtEnds[posi];
+        return;
+    }
+    if (profiling && execute) {
+        profiledStmt();
+        return;
+    }
+    statement(execute);
+}
+
+void SemanticAnalyzer::statement(bool execute) {
     if (peek() == "if") ifstmt(execute);
+    else if (peek() == "while") whilestmt(execute);
     else if (peek() == "{") compoundstmt(execute);
     else assgstmt(execute);
 }
 
+// 剖析时每条执行的语句计时，自身耗时为总耗时减去内层语句的总耗时
+void SemanticAnalyzer::profiledStmt() {
+    int id = posi < (int)stmtIds.size() ? stmtIds[posi] : -1;
+    if (id < 0) {
+        statement(true);
+        return;
+    }
+    uint64_t outer = childNanos;
+    childNanos = 0;
+    auto start = chrono::steady_clock::now();
+    statement(true);
+    uint64_t elapsed = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+    SemStmtProfile& s = profileData.stmts[id];
+    s.count++;
+    s.totalNanos += elapsed;
+    s.selfNanos += elapsed - min(childNanos, elapsed);
+    childNanos = outer + elapsed;
+}
+
+// 记录if/while条件的一次结果，start为语句的起始记号
+void SemanticAnalyzer::countBranch(int start, bool cond) {
+    int id = start < (int)stmtIds.size() ? stmtIds[start] : -1;
+    if (id < 0) return;
+    if (cond) profileData.stmts[id].taken++;
+    else profileData.stmts[id].notTaken++;
+}
+
 void SemanticAnalyzer::compoundstmt(bool execute) {
     get(); // {
     while (peek() != "}") {
@@ -147,31 +192,51 @@ void SemanticAnalyzer::compoundstmt(bool execute) {
 }
 
 void SemanticAnalyzer::assgstmt(bool execute) {
-    string id = get();
+    int slot = slotAt(posi);
+    get(); // id
     get(); // =
-    auto v = arithexpr();
+    SemValue v = arithexpr();
     get(); // ;
 
+    // int/real赋值检查已由静态类型检查在执行前完成
     if (execute) {
-        if (symtab[id].type == "int" && v.first == "real")
-            error("realnum can not be translated into int type");
         if (!errors.empty()) return; // 如果有错误，不更新值
-        symtab[id].value = (symtab[id].type == "int") ? (int)v.second : v.second;
+        semAssign(symtab[slot], v);
     }
 }
 
 void SemanticAnalyzer::ifstmt(bool execute) {
+    int start = posi;
     get(); // if
     get(); // (
     bool cond = boolexpr();
     get(); // )
     get(); // then
+    if (profiling && execute) countBranch(start, cond);
 
     stmt(execute && cond);
     get(); // else
     stmt(execute && !cond);
 }
 
+// while ( boolexpr ) stmt：每轮回到条件处重新解释。
+// 出现错误后赋值不再生效、循环无法前进，因此已有错误时不再回到条件处
+void SemanticAnalyzer::whilestmt(bool execute) {
+    int start = posi;
+    for (;;) {
+        posi = start;
+        get(); // while
+        get(); // (
+        bool cond = boolexpr();
+        get(); // )
+        if (profiling && execute) countBranch(start, cond);
+
+        stmt(execute && cond);
+        if (!(execute && cond) || !errors.empty()) break;
+        if (meter.armed() && !meter.tick()) break;
+    }
+}
+
 // 声明函数实现
 void SemanticAnalyzer::decls() {
     while (peek() == "int" || peek() == "real") {
@@ -181,50 +246,273 @@ void SemanticAnalyzer::decls() {
         string val = get();
         get(); // ;
 
-        Var v;
-        v.type = type;
+        Var& v = symtab[symtab.declare(id, type == "int" ? SEM_INT : SEM_REAL)];
         if (type == "int") {
             if (!isInt(val)) error("realnum can not be translated into int type");
-            v.value = stoi(val);
+            if (!semParseInt(val, v.i)) error("integer literal out of range");
         } else {
-            v.value = stod(val);
+            v.r = strtod(val.c_str(), nullptr);
         }
-        symtab[id] = v;
     }
 }
 
-// 分析函数
-void SemanticAnalyzer::analyze(const string& prog) {
+// 名字解析实现
+vector<int> SemanticAnalyzer::resolve(const SemProgram& program) {
+    vector<int> varSlots(program.varNames.size());
+    for (size_t i = 0; i < varSlots.size(); i++) {
+        const string& name = program.varNames[i];
+        int slot = symtab.lookup(name);
+        if (slot < 0) {
+            error("undeclared variable " + name);
+            slot = symtab.declareUntyped(name);
+        }
+        varSlots[i] = slot;
+    }
+
+    tokenSlots.assign(tokens.size(), -1);
+    for (const auto& ref : program.varRefs) {
+        tokenSlots[ref.first] = varSlots[ref.second];
+    }
+    return varSlots;
+}
+
+void SemanticAnalyzer::indexStatements(const SemProgram& program) {
+    stmtEnds.assign(tokens.size(), -1);
+    for (const SemStmt& s : program.stmts) {
+        if (s.begin < stmtEnds.size()) stmtEnds[s.begin] = (int)s.end;
+    }
+}
+
+void SemanticAnalyzer::profileInterpreter(const SemProgram& program) {
+    indexStatements(program);
+    if (!meter.charge(program.stmts.size() * sizeof(SemStmtProfile))) return;
+
+    // 每条语句以开头的几个记号作为说明
+    const size_t shown = 8;
+    profileData.stmts.resize(program.stmts.size());
+    stmtIds.assign(tokens.size(), -1);
+    for (size_t i = 0; i < program.stmts.size(); i++) {
+        const SemStmt& st = program.stmts[i];
+        SemStmtProfile& s = profileData.stmts[i];
+        s.stmt = (int)i;
+        s.kind = st.kind;
+        s.line = st.begin < tokenLines.size() ? tokenLines[st.begin] : 0;
+        size_t end = min(st.end, tokens.size());
+        for (size_t k = st.begin; k < end && k < st.begin + shown; k++) {
+            if (k > st.begin) s.text += ' ';
+            s.text += tokens[k];
+        }
+        if (end > st.begin + shown) s.text += " ...";
+        if (st.begin < stmtIds.size()) stmtIds[st.begin] = (int)i;
+    }
+
+    childNanos = 0;
+    auto start = chrono::steady_clock::now();
+    compoundstmt(true);
+    profileData.totalNanos =
+        (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    profileData.collectLines();
+}
+
+// 逐记号解释时取变量槽位；解析阶段未覆盖到的位置按名字查找
+int SemanticAnalyzer::slotAt(int pos) {
+    if (pos < (int)tokenSlots.size() && tokenSlots[pos] >= 0) return tokenSlots[pos];
+    const string& name = pos < (int)tokens.size() ? tokens[pos] : string();
+    int slot = symtab.lookup(name);
+    return slot >= 0 ? slot : symtab.declareUntyped(name);
+}
+
+// 前端：重置状态后完成声明、语法树、名字解析与静态类型检查，返回语法树
+SemProgram SemanticAnalyzer::frontEnd(const string& prog, bool reportParseErrors, vector<int>& varSlots) {
     // 重置状态
     tokens.clear();
+    tokenSlots.clear();
+    stmtEnds.clear();
     symtab.clear();
     errors.clear();
+    typeInfo = SemTypeInfo();
+    passReport = IRPassReport();
+    profileData = SemProfile();
+    tokenLines.clear();
+    stmtIds.clear();
     flag = false;
     posi = 0;
+    meter.start(budget, cancelToken);
     
     // 词法分析
     stringstream ss(prog);
     string t;
     while (ss >> t) tokens.push_back(t);
+    if (profiling) tokenLines = semTokenLines(prog);
+    if (!meter.charge(prog.size() + tokens.size() * sizeof(string)) || !meter.poll()) return SemProgram();
     
     // 语义分析
     decls();
-    compoundstmt(true);
+    SemProgram program = parseSemanticProgram(tokens, posi, budget.maxDepth);
+    // 嵌套过深时语法树不完整，各遍的递归也不再安全，到此为止
+    if (program.tooDeep) meter.abort(SEM_ABORT_DEPTH);
+    if (!meter.charge(program.exprs.size() * sizeof(SemExpr) + program.stmts.size() * sizeof(SemStmt)) ||
+        !meter.poll()) {
+        return SemProgram();
+    }
+    if (reportParseErrors) {
+        for (const string& msg : program.errors) error(msg);
+    }
+    varSlots = resolve(program);
+
+    // 静态类型检查：执行前一次性报告全部赋值类型错误
+    vector<SemType> varTypes(varSlots.size());
+    for (size_t i = 0; i < varSlots.size(); i++) varTypes[i] = symtab[varSlots[i]].type;
+    typeInfo = checkSemanticTypes(program, varTypes);
+    for (const string& msg : typeInfo.errors) error(msg);
+    return program;
+}
+
+// 分析函数
+void SemanticAnalyzer::analyze(const string& prog) {
+    // 逐记号解释在执行到语法错误处时才报告；剖析时也用逐记号解释
+    bool interpret = !useBytecode || profiling;
+    vector<int> varSlots;
+    SemProgram program = frontEnd(prog, !interpret, varSlots);
+
+    // 前端中止（嵌套过深、超出内存预算等）时不再执行
+    if (!meter.aborted()) {
+        if (!interpret) {
+            runBytecode(program, varSlots);
+        } else if (profiling) {
+            profileInterpreter(program);
+        } else {
+            indexStatements(program);
+            compoundstmt(true);
+        }
+    }
+    if (meter.aborted()) record(semAbortMessage(meter.abortReason()));
+}
+
+bool SemanticAnalyzer::compileToAssembly(const string& prog, ostream& out, string& failure) {
+    vector<int> varSlots;
+    SemProgram program = frontEnd(prog, true, varSlots);
+    if (meter.aborted()) {
+        failure = semAbortMessage(meter.abortReason());
+        return false;
+    }
+
+    // 与runBytecode相同：优化版本按初始值特化，除零时退回未优化的精确版本
+    IRFunction precise = lowerSemanticProgram(program, varSlots, typeInfo, symtab.size());
+    IRFunction fast = precise;
+    fast.entryValues.assign(symtab.data(), symtab.data() + symtab.size());
+    passReport = optimizeIR(fast);
+    return generateSemanticAssembly(fast, precise, symtab, errors, out, failure);
+}
+
+bool SemanticAnalyzer::analyzeBatch(const string& prog, const SemBatchTable& inputs, SemBatchResult& out,
+                                    string& failure) {
+    vector<int> varSlots;
+    SemProgram program = frontEnd(prog, true, varSlots);
+
+    // 各行初始值不同，优化版本不按初始值特化
+    IRFunction precise;
+    IRFunction fast;
+    if (!meter.aborted()) {
+        precise = lowerSemanticProgram(program, varSlots, typeInfo, symtab.size());
+        fast = precise;
+        if (optimize) passReport = optimizeIR(fast);
+    }
+    if (meter.aborted() || !chargeIR(precise) || (optimize && !chargeIR(fast))) {
+        failure = semAbortMessage(meter.abortReason());
+        return false;
+    }
+    return runSemanticBatch(optimize ? &fast : nullptr, precise, symtab, errors, inputs, out, failure, &meter);
+}
+
+void SemanticAnalyzer::runBytecode(const SemProgram& program, const vector<int>& varSlots) {
+    IRFunction ir = lowerSemanticProgram(program, varSlots, typeInfo, symtab.size());
+    jitReport = SemJitStats();
+    if (!chargeIR(ir)) return;
+
+    if (optimize && errors.empty()) {
+        // 优化后的代码按本次的初始值特化，并假定执行中不出错；
+        // 一旦除零就放弃，从头精确执行未优化的代码（程序没有其他副作用，结果相同）
+        IRFunction opt = ir;
+        opt.entryValues.assign(symtab.data(), symtab.data() + symtab.size());
+        passReport = optimizeIR(opt);
+        if (!chargeIR(opt)) return;
+        // 因预算或取消而中止时不再重新执行
+        if (execute(opt, SemanticVM::SPECULATIVE) || meter.aborted()) return;
+    }
+    execute(ir, SemanticVM::PRECISE);
+}
+
+bool SemanticAnalyzer::chargeIR(const IRFunction& fn) {
+    size_t frame = (size_t)fn.varCount + fn.constants.size() + (size_t)fn.tempCount;
+    return meter.charge(fn.instrCount() * sizeof(IRInstr) + fn.blocks.size() * sizeof(IRBlock) +
+                        fn.constants.size() * sizeof(SemValue) + frame * sizeof(SemValue)) &&
+           meter.poll();
+}
+
+// 虚拟机与JIT代码都直接读写符号表的槽位数组
+bool SemanticAnalyzer::execute(const IRFunction& fn, SemanticVM::Mode mode) {
+    auto onError = [this](const string& msg) { error(msg); };
+    bool hasError = !errors.empty();
+    // 计步时在回跳处检查预算与取消
+    SemBudgetMeter* steps = meter.armed() ? &meter : nullptr;
+    if (useJit) {
+        using Clock = chrono::steady_clock;
+        auto micros = [](Clock::time_point from) {
+            return chrono::duration<double, micro>(Clock::now() - from).count();
+        };
+        SemJitFunction jit;
+        auto start = Clock::now();
+        bool compiled = jit.compile(fn, mode, steps != nullptr);
+        jitReport.compileMicros += micros(start);
+        if (compiled) {
+            jitReport.functions++;
+            start = Clock::now();
+            bool done = jit.run(symtab.data(), hasError, onError, steps);
+            jitReport.executeMicros += micros(start);
+            return done;
+        }
+        jitReport.fallbacks++;
+    }
+    SemanticVM vm;
+    return vm.run(compileSemanticIR(fn, steps != nullptr), symtab.data(), mode, hasError, onError, steps);
 }
 
 // 打印结果
-void SemanticAnalyzer::printResults() const {
+void SemanticAnalyzer::printResults(ostream& out) const {
+    SinkFor sink(out);
     // 如果有错误，输出所有错误信息
     if (!errors.empty()) {
         for (size_t i = 0; i < errors.size(); i++) {
-            cout << errors[i];
-            if (i != errors.size() - 1) cout << endl;
+            *sink << errors[i];
+            if (i != errors.size() - 1) *sink << '\n';
         }
         return;
     }
     
-    // 输出变量值
-    cout << "a: " << (int)symtab.at("a").value << endl;
-    cout << "b: " << (int)symtab.at("b").value << endl;
-    cout << "c: " << symtab.at("c").value<<endl;
+    // 输出变量值：a、b按整数输出（int变量直接输出64位值）
+    auto integer = [](const Var& v) { return v.isReal() ? (int64_t)v.r : v.i; };
+    *sink << "a: " << integer(symtab.at("a")) << '\n';
+    *sink << "b: " << integer(symtab.at("b")) << '\n';
+    *sink << "c: " << symtab.at("c").number() << '\n';
+}
+
+void SemanticAnalyzer::writeNdjson(ostream& out) const {
+    SinkFor sink(out);
+    static const string prefix = "error message:line ";
+    for (const string& e : errors) {
+        // 错误信息的格式为"error message:line N,说明"，其中的N是与原实现一致的固定值
+        // （首条为1，其余为5），不是真实行号，因此记录中只保留说明
+        size_t comma = e.find(',');
+        bool prefixed = e.compare(0, prefix.size(), prefix) == 0 && comma != string::npos;
+        NdjsonRecord(*sink, "diagnostic").field("phase", "sem").field("message", prefixed ? e.substr(comma + 1) : e);
+    }
+    if (!errors.empty()) return;
+    for (int s = 0; s < symtab.size(); s++) {
+        const Var& v = symtab[s];
+        NdjsonRecord record(*sink, "var");
+        record.field("name", symtab.name(s)).field("type", v.isReal() ? "real" : "int");
+        if (v.isReal()) record.field("value", v.r);
+        else record.field("value", v.i);
+    }
 }
\ No newline at end of file
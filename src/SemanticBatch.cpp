@@ -0,0 +1,349 @@
+// SemanticBatch.cpp
+#include "SemanticBatch.h"
+#include "SemanticVM.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+const SemColumn* SemBatchTable::find(const string& name) const {
+    for (const SemColumn& c : columns) {
+        if (c.name == name) return &c;
+    }
+    return nullptr;
+}
+
+const SemColumn* SemBatchResult::find(const string& name) const {
+    for (const SemColumn& c : columns) {
+        if (c.name == name) return &c;
+    }
+    return nullptr;
+}
+
+vector<string> SemBatchResult::errorMessages(size_t row) const {
+    // 与SemanticAnalyzer::error相同：第一个错误标为line 1，其后标为line 5
+    vector<string> msgs = staticErrors;
+    for (uint32_t k = 0; k < divisionErrors[row]; k++) {
+        msgs.push_back(msgs.empty() ? "error message:line 1,division by zero" : "error message:line 5,division by zero");
+    }
+    return msgs;
+}
+
+namespace {
+
+const int W = SEM_BATCH_LANES;
+const int64_t DONE = INT64_MAX;     // 已执行完毕（或放弃）的行所在的“块”
+
+// 按掩码选择：m为全1时取x，为0时保留old；int与real都按位选择，便于向量化
+inline int64_t blend(int64_t x, int64_t old, int64_t m) { return (x & m) | (old & ~m); }
+
+inline int64_t realBits(double d) {
+    SemWord w;
+    w.r = d;
+    return w.i;
+}
+
+// 按掩码逐行写入：d[l] = m[l] ? value(l) : d[l]。掩码声明为restrict，
+// 否则编译器无法排除经d写入改变掩码的可能，不会把循环向量化
+template <class Value>
+inline void maskedWrite(int64_t* d, const int64_t* __restrict m, Value value) {
+    for (int l = 0; l < W; l++) d[l] = blend(value(l), d[l], m[l]);
+}
+
+// 一组W行的执行状态，帧按“槽位 × 行”排列
+class LaneGroup {
+public:
+    LaneGroup(const IRFunction& f, bool spec) : fn(f), speculative(spec) {
+        constBase = fn.varCount;
+        tempBase = constBase + (int)fn.constants.size();
+        frame.assign((size_t)(tempBase + fn.tempCount) * W, SemWord());
+        for (size_t k = 0; k < fn.constants.size(); k++) {
+            SemWord* c = &frame[(constBase + k) * W];
+            for (int l = 0; l < W; l++) c[l].i = fn.constants[k].i;
+        }
+    }
+
+    SemWord* var(int v) { return &frame[(size_t)v * W]; }
+
+    // 执行前count行（变量已由调用方写入帧），hasError表示执行前已有错误；
+    // 预算用完或被取消时返回false
+    bool run(int count, bool hasError, SemBudgetMeter* meter) {
+        for (int l = 0; l < W; l++) {
+            pc[l] = l < count ? 0 : DONE;
+            error[l] = hasError ? -1 : 0;
+            bailed[l] = 0;
+            divisions[l] = 0;
+        }
+        int64_t previous = -1;
+        for (;;) {
+            int64_t block = DONE;
+            for (int l = 0; l < W; l++) block = min(block, pc[l]);
+            if (block == DONE) return true;
+            if (meter && block <= previous && !meter->tick()) return false;
+            previous = block;
+            for (int l = 0; l < W; l++) mask[l] = pc[l] == block ? -1 : 0;
+            executeBlock(fn.blocks[block]);
+            // 已出错的行赋值不再生效、循环无法前进，回跳时结束
+            maskedWrite(pc, mask, [&](int l) { return error[l] && pc[l] <= block ? DONE : pc[l]; });
+        }
+    }
+
+    uint8_t bailed[W];
+    uint32_t divisions[W];
+
+private:
+    const IRFunction& fn;
+    bool speculative;
+    int constBase = 0, tempBase = 0;
+    vector<SemWord> frame;
+    int64_t pc[W];
+    int64_t mask[W];
+    int64_t error[W];       // 精确执行中该行已出错（全1），此后赋值不再生效
+
+    SemWord* col(int operand) {
+        switch (irKind(operand)) {
+        case IR_VAR: return &frame[(size_t)irIndex(operand) * W];
+        case IR_CONST: return &frame[(size_t)(constBase + irIndex(operand)) * W];
+        default: return &frame[(size_t)(tempBase + irIndex(operand)) * W];
+        }
+    }
+
+    // 活动行中出现除零：推测执行时该行放弃并退出本组；精确执行时计数并置错误标志
+    void divisionByZero(const SemWord* b, bool real) {
+        for (int l = 0; l < W; l++) {
+            if (!mask[l] || (real ? b[l].r != 0.0 : b[l].i != 0)) continue;
+            if (speculative) {
+                bailed[l] = 1;
+                pc[l] = DONE;
+                mask[l] = 0;
+            } else {
+                error[l] = -1;
+                divisions[l]++;
+            }
+        }
+    }
+
+    template <class Op>
+    void intOp(SemWord* d, const SemWord* a, const SemWord* b, Op op) {
+        maskedWrite(&d->i, mask, [=](int l) { return op(a[l].i, b[l].i); });
+    }
+
+    template <class Op>
+    void realOp(SemWord* d, const SemWord* a, const SemWord* b, Op op) {
+        maskedWrite(&d->i, mask, [=](int l) { return realBits(op(a[l].r, b[l].r)); });
+    }
+
+    void executeInstr(const IRInstr& in) {
+        SemWord* d = col(in.dst);
+        const SemWord* a = col(in.a);
+        const SemWord* b = (in.op >= IR_IADD && in.op <= IR_RDIV) ? col(in.b) : nullptr;
+        switch (in.op) {
+        case IR_COPY:
+            maskedWrite(&d->i, mask, [=](int l) { return a[l].i; });
+            break;
+        case IR_STORE: {
+            int64_t keep[W];
+            for (int l = 0; l < W; l++) keep[l] = mask[l] & ~error[l];
+            maskedWrite(&d->i, keep, [=](int l) { return a[l].i; });
+            break;
+        }
+        case IR_I2R:
+            maskedWrite(&d->i, mask, [=](int l) { return realBits((double)a[l].i); });
+            break;
+        case IR_IADD: intOp(d, a, b, semWrapAdd); break;
+        case IR_ISUB: intOp(d, a, b, semWrapSub); break;
+        case IR_IMUL: intOp(d, a, b, semWrapMul); break;
+        case IR_IDIV: {
+            int64_t zero = 0;
+            for (int l = 0; l < W; l++) zero |= mask[l] & (b[l].i == 0 ? -1 : 0);
+            if (zero) divisionByZero(b, false);
+            // 除数为0的行（包括非活动行）不做除法，保留左值
+            intOp(d, a, b, [](int64_t x, int64_t y) { return y == 0 ? x : semWrapDiv(x, y); });
+            break;
+        }
+        case IR_RADD: realOp(d, a, b, [](double x, double y) { return x + y; }); break;
+        case IR_RSUB: realOp(d, a, b, [](double x, double y) { return x - y; }); break;
+        case IR_RMUL: realOp(d, a, b, [](double x, double y) { return x * y; }); break;
+        case IR_RDIV: {
+            int64_t zero = 0;
+            for (int l = 0; l < W; l++) zero |= mask[l] & (b[l].r == 0.0 ? -1 : 0);
+            if (zero) divisionByZero(b, true);
+            realOp(d, a, b, [](double x, double y) { return y == 0.0 ? x : x / y; });
+            break;
+        }
+        }
+    }
+
+    template <class Cmp>
+    void branch(const SemWord* x, const SemWord* y, int64_t t, int64_t f, Cmp cmp) {
+        maskedWrite(pc, mask, [=](int l) { return cmp(x[l], y[l]) ? t : f; });
+    }
+
+    void executeBlock(const IRBlock& b) {
+        for (const IRInstr& in : b.code) executeInstr(in);
+
+        switch (b.term) {
+        case IR_HALT:
+            maskedWrite(pc, mask, [](int) { return DONE; });
+            break;
+        case IR_JUMP:
+            maskedWrite(pc, mask, [&](int) { return (int64_t)b.succ[0]; });
+            break;
+        case IR_BRANCH: {
+            const SemWord* x = col(b.lhs);
+            const SemWord* y = col(b.rhs);
+            int64_t t = b.succ[0], f = b.succ[1];
+            if (b.realCompare) {
+                switch (b.rel) {
+                case REL_LT: branch(x, y, t, f, [](SemWord p, SemWord q) { return p.r < q.r; }); break;
+                case REL_GT: branch(x, y, t, f, [](SemWord p, SemWord q) { return p.r > q.r; }); break;
+                case REL_LE: branch(x, y, t, f, [](SemWord p, SemWord q) { return p.r <= q.r; }); break;
+                case REL_GE: branch(x, y, t, f, [](SemWord p, SemWord q) { return p.r >= q.r; }); break;
+                case REL_EQ: branch(x, y, t, f, [](SemWord p, SemWord q) { return p.r == q.r; }); break;
+                default: branch(x, y, t, f, [](SemWord, SemWord) { return false; }); break;
+                }
+            } else {
+                switch (b.rel) {
+                case REL_LT: branch(x, y, t, f, [](SemWord p, SemWord q) { return p.i < q.i; }); break;
+                case REL_GT: branch(x, y, t, f, [](SemWord p, SemWord q) { return p.i > q.i; }); break;
+                case REL_LE: branch(x, y, t, f, [](SemWord p, SemWord q) { return p.i <= q.i; }); break;
+                case REL_GE: branch(x, y, t, f, [](SemWord p, SemWord q) { return p.i >= q.i; }); break;
+                case REL_EQ: branch(x, y, t, f, [](SemWord p, SemWord q) { return p.i == q.i; }); break;
+                default: branch(x, y, t, f, [](SemWord, SemWord) { return false; }); break;
+                }
+            }
+            break;
+        }
+        }
+    }
+};
+
+// 一个变量各行初始值的来源：输入列，或声明头中的值
+struct VarSource {
+    const SemColumn* column = nullptr;
+    bool real = false;
+    int64_t fallback = 0;
+};
+
+// 执行rowIds中的count行（count不超过W），把结果写入out，放弃的行加入retry；
+// 预算用完或被取消时返回false
+bool runRows(LaneGroup& group, const vector<VarSource>& sources, const size_t* rowIds, int count,
+             bool hasError, SemBatchResult& out, vector<size_t>& retry, SemBudgetMeter* meter) {
+    for (size_t v = 0; v < sources.size(); v++) {
+        const VarSource& s = sources[v];
+        SemWord* dst = group.var((int)v);
+        for (int l = 0; l < count; l++) {
+            if (!s.column) {
+                dst[l].i = s.fallback;
+            } else if (s.column->type == SEM_REAL) {
+                dst[l].r = s.column->reals[rowIds[l]];
+            } else if (s.real) {
+                dst[l].r = (double)s.column->ints[rowIds[l]];
+            } else {
+                dst[l].i = s.column->ints[rowIds[l]];
+            }
+        }
+    }
+
+    if (!group.run(count, hasError, meter)) return false;
+
+    for (int l = 0; l < count; l++) {
+        if (group.bailed[l]) retry.push_back(rowIds[l]);
+        else out.divisionErrors[rowIds[l]] = group.divisions[l];
+    }
+    for (size_t v = 0; v < sources.size(); v++) {
+        SemColumn& c = out.columns[v];
+        const SemWord* src = group.var((int)v);
+        for (int l = 0; l < count; l++) {
+            if (group.bailed[l]) continue;
+            if (sources[v].real) c.reals[rowIds[l]] = src[l].r;
+            else c.ints[rowIds[l]] = src[l].i;
+        }
+    }
+    return true;
+}
+
+}
+
+bool runSemanticBatch(const IRFunction* optimized, const IRFunction& precise, const SymbolTable& symbols,
+                      const vector<string>& staticErrors, const SemBatchTable& inputs,
+                      SemBatchResult& out, string& failure, SemBudgetMeter* meter) {
+    vector<VarSource> sources(symbols.size());
+    for (int v = 0; v < symbols.size(); v++) {
+        sources[v].real = symbols[v].isReal();
+        sources[v].fallback = symbols[v].i;
+    }
+    for (const SemColumn& c : inputs.columns) {
+        int slot = symbols.lookup(c.name);
+        if (slot < 0) {
+            failure = "输入列" + c.name + "不是已声明的变量";
+            return false;
+        }
+        if (c.size() != inputs.rows) {
+            failure = "输入列" + c.name + "的行数与表不符";
+            return false;
+        }
+        // 与声明相同：int变量不接受real值，real变量接受int值
+        if (c.type == SEM_REAL && !sources[slot].real) {
+            failure = "输入列" + c.name + "为real，变量" + c.name + "为int";
+            return false;
+        }
+        sources[slot].column = &c;
+    }
+
+    if (meter) {
+        size_t frames = (size_t)(precise.varCount + precise.constants.size() + precise.tempCount) * W;
+        if (optimized) frames += (size_t)(optimized->varCount + optimized->constants.size() + optimized->tempCount) * W;
+        size_t columns = inputs.rows * (sizeof(SemWord) * symbols.size() + sizeof(uint32_t));
+        if (!meter->charge(frames * sizeof(SemWord) + columns)) {
+            failure = semAbortMessage(meter->abortReason());
+            return false;
+        }
+    }
+    // 不计步时不检查
+    SemBudgetMeter* steps = meter && meter->armed() ? meter : nullptr;
+
+    out = SemBatchResult();
+    out.rows = inputs.rows;
+    out.staticErrors = staticErrors;
+    out.divisionErrors.assign(inputs.rows, 0);
+    out.columns.resize(symbols.size());
+    for (int v = 0; v < symbols.size(); v++) {
+        SemColumn& c = out.columns[v];
+        c.name = symbols.name(v);
+        c.type = symbols[v].type;
+        if (sources[v].real) c.reals.resize(inputs.rows);
+        else c.ints.resize(inputs.rows);
+    }
+
+    bool hasError = !staticErrors.empty();
+    bool speculate = optimized && !hasError;
+    vector<size_t> rowIds(W), retry;
+    {
+        LaneGroup group(speculate ? *optimized : precise, speculate);
+        for (size_t start = 0; start < inputs.rows; start += W) {
+            int count = (int)min((size_t)W, inputs.rows - start);
+            for (int l = 0; l < count; l++) rowIds[l] = start + l;
+            if (!runRows(group, sources, rowIds.data(), count, hasError, out, retry, steps)) {
+                failure = semAbortMessage(meter->abortReason());
+                return false;
+            }
+        }
+    }
+
+    // 推测执行放弃的行从头精确执行
+    if (!retry.empty()) {
+        LaneGroup group(precise, false);
+        vector<size_t> none;
+        for (size_t start = 0; start < retry.size(); start += W) {
+            int count = (int)min((size_t)W, retry.size() - start);
+            if (!runRows(group, sources, retry.data() + start, count, hasError, out, none, steps)) {
+                failure = semAbortMessage(meter->abortReason());
+                return false;
+            }
+        }
+    }
+    out.preciseRows = retry.size();
+    return true;
+}
@@ -0,0 +1,85 @@
+// SemanticBudget.cpp
+#include "SemanticBudget.h"
+
+#include <algorithm>
+
+using namespace std;
+
+const char* semAbortMessage(SemAbortReason reason) {
+    switch (reason) {
+    case SEM_ABORT_STEPS: return "step budget exceeded";
+    case SEM_ABORT_MEMORY: return "memory budget exceeded";
+    case SEM_ABORT_TIME: return "time budget exceeded";
+    case SEM_ABORT_DEPTH: return "nesting too deep";
+    case SEM_ABORT_CANCELLED: return "execution cancelled";
+    default: return "";
+    }
+}
+
+void SemBudgetMeter::start(const SemBudget& budget, const SemCancelToken* token) {
+    limits = budget;
+    if (limits.checkInterval < 1) limits.checkInterval = 1;
+    cancel = token;
+    timed = limits.maxMillis > 0;
+    if (timed) {
+        deadline = chrono::steady_clock::now() +
+                   chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(limits.maxMillis));
+    }
+    stepChecks = limits.maxSteps > 0 || timed || cancel;
+    reason = SEM_ABORT_NONE;
+    used = 0;
+    bytes = 0;
+    chunk = nextChunk();
+    fuel = chunk;
+}
+
+int64_t SemBudgetMeter::nextChunk() const {
+    if (limits.maxSteps == 0) return limits.checkInterval;
+    uint64_t left = limits.maxSteps > used ? limits.maxSteps - used : 0;
+    return (int64_t)min<uint64_t>(left, (uint64_t)limits.checkInterval);
+}
+
+int64_t SemBudgetMeter::refuel() {
+    if (aborted()) {
+        fuel = 0;
+        return -1;
+    }
+    used += (uint64_t)chunk;
+    chunk = 0;
+    fuel = 0;
+    if (limits.maxSteps > 0 && used >= limits.maxSteps) {
+        abort(SEM_ABORT_STEPS);
+        return -1;
+    }
+    if (!poll()) return -1;
+    chunk = nextChunk();
+    fuel = chunk - 1;
+    return fuel;
+}
+
+bool SemBudgetMeter::poll() {
+    if (aborted()) return false;
+    if (cancel && cancel->cancelled()) {
+        abort(SEM_ABORT_CANCELLED);
+        return false;
+    }
+    if (timed && chrono::steady_clock::now() >= deadline) {
+        abort(SEM_ABORT_TIME);
+        return false;
+    }
+    return true;
+}
+
+bool SemBudgetMeter::charge(size_t n) {
+    if (aborted()) return false;
+    bytes += n;
+    if (limits.maxMemory > 0 && bytes > limits.maxMemory) {
+        abort(SEM_ABORT_MEMORY);
+        return false;
+    }
+    return true;
+}
+
+void SemBudgetMeter::abort(SemAbortReason why) {
+    if (reason == SEM_ABORT_NONE) reason = why;
+}
@@ -0,0 +1,657 @@
+// SemanticCodegen.cpp
+#include "SemanticCodegen.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <ostream>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+// 操作数在生成代码中的位置，text为AT&T语法的写法
+struct Loc {
+    enum Kind : uint8_t { NONE, GPR, XMM, MEM, IMM } kind = NONE;
+    string text;
+
+    bool operator==(const Loc& o) const { return kind == o.kind && text == o.text; }
+    bool operator!=(const Loc& o) const { return !(*this == o); }
+};
+
+Loc gpr(const char* name) { return { Loc::GPR, string("%") + name }; }
+Loc xmm(int n) { return { Loc::XMM, "%xmm" + to_string(n) }; }
+Loc mem(const string& s) { return { Loc::MEM, s }; }
+Loc imm(int64_t v) { return { Loc::IMM, "$" + to_string(v) }; }
+
+const Loc RAX = gpr("rax");
+const Loc R11 = gpr("r11");
+const Loc XMM15 = xmm(15);
+
+// 变量用被调用者保存的寄存器，临时值用调用者保存的寄存器
+const char* const VAR_GPRS[] = { "rbx", "rbp", "r12", "r13", "r14", "r15" };
+const int VAR_XMMS[] = { 8, 9, 10, 11, 12, 13 };
+const char* const TEMP_GPRS[] = { "rcx", "rsi", "rdi", "r8", "r9", "r10" };
+const int TEMP_XMMS = 8;
+
+string varHome(int slot) { return "sem_vars+" + to_string(slot * 8) + "(%rip)"; }
+
+int64_t realBits(double d) {
+    int64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+string asmString(const string& s) {
+    string r = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            r += '\\';
+            r += (char)c;
+        } else if (c == '\n') {
+            r += "\\n";
+        } else if (c < 0x20 || c >= 0x7f) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\%03o", c);
+            r += buf;
+        } else {
+            r += (char)c;
+        }
+    }
+    return r + "\"";
+}
+
+// 只读数据区中的8字节常量，相同的值共用一个标签
+class ConstPool {
+public:
+    Loc at(int64_t bits) {
+        auto it = labels.find(bits);
+        if (it == labels.end()) it = labels.emplace(bits, ".LC" + to_string(labels.size())).first;
+        return mem(it->second + "(%rip)");
+    }
+
+    void emit(ostream& out) const {
+        for (const auto& e : labels) {
+            out << "    .align 8\n" << e.second << ":\n    .quad " << e.first << "\n";
+        }
+    }
+
+private:
+    map<int64_t, string> labels;
+};
+
+// 把一个IRFunction生成为一个函数：返回时eax为1表示执行完毕，为0表示放弃（只在推测版本中出现）
+class FunctionEmitter {
+public:
+    FunctionEmitter(const IRFunction& f, const vector<SemType>& types, bool spec, const string& n,
+                    ConstPool& p)
+        : fn(f), varTypes(types), speculative(spec), name(n), pool(p) {}
+
+    void run(ostream& out) {
+        classifyTemps();
+        allocateVars();
+        for (size_t b = 0; b < fn.blocks.size(); b++) emitBlock((int)b);
+
+        // 溢出区放在被调用者保存的寄存器之下，保持rsp按16字节对齐
+        int frame = slotCount * 8;
+        if (frame % 16 == 0) frame += 8;
+
+        out << "    .p2align 4\n" << name << ":\n";
+        for (const char* r : VAR_GPRS) out << "    pushq %" << r << "\n";
+        out << "    subq $" << frame << ", %rsp\n";
+        for (int v = 0; v < fn.varCount; v++) {
+            if (varLoc[v].kind == Loc::GPR) out << "    movq " << varHome(v) << ", " << varLoc[v].text << "\n";
+            if (varLoc[v].kind == Loc::XMM) out << "    movsd " << varHome(v) << ", " << varLoc[v].text << "\n";
+        }
+        out << code.str();
+        out << label("exit") << ":\n";
+        for (int v = 0; v < fn.varCount; v++) {
+            if (varLoc[v].kind == Loc::GPR) out << "    movq " << varLoc[v].text << ", " << varHome(v) << "\n";
+            if (varLoc[v].kind == Loc::XMM) out << "    movsd " << varLoc[v].text << ", " << varHome(v) << "\n";
+        }
+        out << "    movl $1, %eax\n";
+        out << label("ret") << ":\n";
+        out << "    addq $" << frame << ", %rsp\n";
+        for (int i = 5; i >= 0; i--) out << "    popq %" << VAR_GPRS[i] << "\n";
+        out << "    ret\n";
+        if (speculative) {
+            out << label("bailout") << ":\n";
+            out << "    xorl %eax, %eax\n";
+            out << "    jmp " << label("ret") << "\n";
+        }
+        out << cold.str();
+    }
+
+private:
+    const IRFunction& fn;
+    const vector<SemType>& varTypes;
+    bool speculative;
+    string name;
+    ConstPool& pool;
+
+    vector<bool> tempReal;
+    vector<Loc> varLoc, tempLoc;
+    vector<int> tempSlot, lastUse;
+    vector<Loc> freeGprs, freeXmms;
+    vector<int> freeSlots;
+    int slotCount = 0;
+    int labelCount = 0;
+    ostringstream code, cold;   // cold: 除零报错等很少执行的路径，放在函数末尾
+
+    string label(const char* kind) const { return ".L" + name + "_" + kind; }
+    string newLabel() { return ".L" + name + "_" + to_string(labelCount++); }
+    string blockLabel(int b) const { return ".L" + name + "_b" + to_string(b); }
+
+    bool isReal(int x) const {
+        switch (irKind(x)) {
+        case IR_CONST: return fn.constants[irIndex(x)].isReal();
+        case IR_VAR: return varTypes[irIndex(x)] == SEM_REAL;
+        default: return tempReal[irIndex(x)];
+        }
+    }
+
+    Loc loc(int x) {
+        switch (irKind(x)) {
+        case IR_CONST: {
+            const SemValue& v = fn.constants[irIndex(x)];
+            if (!v.isReal() && v.i >= INT32_MIN && v.i <= INT32_MAX) return imm(v.i);
+            return pool.at(v.i);
+        }
+        case IR_VAR: return varLoc[irIndex(x)];
+        default: return tempLoc[irIndex(x)];
+        }
+    }
+
+    // 临时值按定义它的运算确定类型；块内先定义后使用，按顺序扫描一遍即可
+    void classifyTemps() {
+        tempReal.assign(fn.tempCount, false);
+        for (const IRBlock& b : fn.blocks) {
+            for (const IRInstr& in : b.code) {
+                if (irKind(in.dst) != IR_TEMP) continue;
+                tempReal[irIndex(in.dst)] = in.op == IR_I2R || (in.op >= IR_RADD && in.op <= IR_RDIV) ||
+                                            (in.op == IR_COPY && isReal(in.a));
+            }
+        }
+    }
+
+    // 按静态使用次数把变量分给寄存器，其余变量留在sem_vars中
+    void allocateVars() {
+        vector<int> uses(fn.varCount, 0);
+        auto use = [&](int x) {
+            if (irKind(x) == IR_VAR) uses[irIndex(x)]++;
+        };
+        for (const IRBlock& b : fn.blocks) {
+            for (const IRInstr& in : b.code) {
+                use(in.dst);
+                use(in.a);
+                if (in.op >= IR_IADD && in.op <= IR_RDIV) use(in.b);
+            }
+            if (b.term == IR_BRANCH) {
+                use(b.lhs);
+                use(b.rhs);
+            }
+        }
+        vector<int> order;
+        for (int v = 0; v < fn.varCount; v++) {
+            if (uses[v] > 0) order.push_back(v);
+        }
+        stable_sort(order.begin(), order.end(), [&](int x, int y) { return uses[x] > uses[y]; });
+
+        varLoc.assign(fn.varCount, Loc());
+        for (int v = 0; v < fn.varCount; v++) varLoc[v] = mem(varHome(v));
+        size_t nextGpr = 0, nextXmm = 0;
+        for (int v : order) {
+            if (varTypes[v] == SEM_REAL) {
+                if (nextXmm < sizeof(VAR_XMMS) / sizeof(VAR_XMMS[0])) varLoc[v] = xmm(VAR_XMMS[nextXmm++]);
+            } else {
+                if (nextGpr < sizeof(VAR_GPRS) / sizeof(VAR_GPRS[0])) varLoc[v] = gpr(VAR_GPRS[nextGpr++]);
+            }
+        }
+
+        tempLoc.assign(fn.tempCount, Loc());
+        tempSlot.assign(fn.tempCount, -1);
+        lastUse.assign(fn.tempCount, -1);
+    }
+
+    void allocTemp(int t) {
+        int i = irIndex(t);
+        vector<Loc>& pool = tempReal[i] ? freeXmms : freeGprs;
+        if (!pool.empty()) {
+            tempLoc[i] = pool.back();
+            pool.pop_back();
+            return;
+        }
+        int slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = slotCount++;
+        }
+        tempSlot[i] = slot;
+        tempLoc[i] = mem(to_string(slot * 8) + "(%rsp)");
+    }
+
+    void releaseTemp(int t) {
+        int i = irIndex(t);
+        if (tempSlot[i] >= 0) {
+            freeSlots.push_back(tempSlot[i]);
+            tempSlot[i] = -1;
+        } else if (tempLoc[i].kind == Loc::XMM) {
+            freeXmms.push_back(tempLoc[i]);
+        } else {
+            freeGprs.push_back(tempLoc[i]);
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // 指令选择
+
+    void movInt(const Loc& src, const Loc& dst) {
+        if (src == dst) return;
+        if (src.kind == Loc::MEM && dst.kind == Loc::MEM) {
+            code << "    movq " << src.text << ", %rax\n";
+            code << "    movq %rax, " << dst.text << "\n";
+            return;
+        }
+        code << "    movq " << src.text << ", " << dst.text << "\n";
+    }
+
+    void movReal(const Loc& src, const Loc& dst) {
+        if (src == dst) return;
+        if (src.kind == Loc::XMM && dst.kind == Loc::XMM) {
+            code << "    movapd " << src.text << ", " << dst.text << "\n";
+        } else if (src.kind == Loc::MEM && dst.kind == Loc::MEM) {
+            code << "    movq " << src.text << ", %rax\n";
+            code << "    movq %rax, " << dst.text << "\n";
+        } else {
+            code << "    movsd " << src.text << ", " << dst.text << "\n";
+        }
+    }
+
+    // 除零：推测版本放弃执行；精确版本报错，被除数留在resume处使用的寄存器中
+    void divisionByZero(const string& resume) {
+        if (speculative) {
+            code << "    jmp " << label("bailout") << "\n";
+            return;
+        }
+        code << "    call sem_div_error\n";
+        if (!resume.empty()) code << "    jmp " << resume << "\n";
+    }
+
+    void branchIfZero(const string& resume) {
+        if (speculative) {
+            code << "    je " << label("bailout") << "\n";
+            return;
+        }
+        string slow = newLabel();
+        code << "    je " << slow << "\n";
+        cold << slow << ":\n    call sem_div_error\n    jmp " << resume << "\n";
+    }
+
+    void intBinary(const char* op, const Loc& d, const Loc& a, const Loc& b) {
+        Loc w = (d.kind == Loc::GPR && d != b) ? d : RAX;
+        movInt(a, w);
+        code << "    " << op << " " << b.text << ", " << w.text << "\n";
+        movInt(w, d);
+    }
+
+    void realBinary(const char* op, const Loc& d, const Loc& a, const Loc& b) {
+        Loc w = (d.kind == Loc::XMM && d != b) ? d : XMM15;
+        movReal(a, w);
+        code << "    " << op << " " << b.text << ", " << w.text << "\n";
+        movReal(w, d);
+    }
+
+    // 与semWrapDiv一致：除数为-1时取负，避免INT64_MIN / -1溢出
+    void intDivide(const Loc& d, const Loc& a, const IRInstr& in) {
+        Loc b = loc(in.b);
+        if (irKind(in.b) == IR_CONST) {
+            int64_t v = fn.constants[irIndex(in.b)].i;
+            movInt(a, RAX);
+            if (v == 0) {
+                divisionByZero("");
+            } else if (v == -1) {
+                code << "    negq %rax\n";
+            } else {
+                code << "    cqto\n";
+                movInt(b, R11);
+                code << "    idivq %r11\n";
+            }
+            movInt(RAX, d);
+            return;
+        }
+        string negate = newLabel(), done = newLabel();
+        movInt(b, R11);
+        movInt(a, RAX);
+        code << "    testq %r11, %r11\n";
+        branchIfZero(done);
+        code << "    cmpq $-1, %r11\n";
+        code << "    je " << negate << "\n";
+        code << "    cqto\n";
+        code << "    idivq %r11\n";
+        code << "    jmp " << done << "\n";
+        code << negate << ":\n";
+        code << "    negq %rax\n";
+        code << done << ":\n";
+        movInt(RAX, d);
+    }
+
+    void realDivide(const Loc& d, const Loc& a, const IRInstr& in) {
+        Loc b = loc(in.b);
+        if (irKind(in.b) == IR_CONST) {
+            if (fn.constants[irIndex(in.b)].r != 0.0) {
+                realBinary("divsd", d, a, b);
+                return;
+            }
+            movReal(a, XMM15);
+            divisionByZero("");
+            movReal(XMM15, d);
+            return;
+        }
+        // 左移一位后为0即为±0.0
+        Loc w = (d.kind == Loc::XMM && d != b) ? d : XMM15;
+        string done = newLabel();
+        code << "    movq " << b.text << ", %r11\n";
+        movReal(a, w);
+        code << "    shlq $1, %r11\n";
+        branchIfZero(done);
+        code << "    divsd " << b.text << ", " << w.text << "\n";
+        code << done << ":\n";
+        movReal(w, d);
+    }
+
+    void intToReal(const Loc& d, int a) {
+        if (irKind(a) == IR_CONST) {
+            movReal(pool.at(realBits((double)fn.constants[irIndex(a)].i)), d);
+            return;
+        }
+        Loc w = d.kind == Loc::XMM ? d : XMM15;
+        code << "    pxor " << w.text << ", " << w.text << "\n";
+        code << "    cvtsi2sdq " << loc(a).text << ", " << w.text << "\n";
+        movReal(w, d);
+    }
+
+    void emitInstr(const IRInstr& in) {
+        Loc a = loc(in.a);
+        if (in.op == IR_STORE) {
+            // 精确版本中出现错误后赋值不再生效
+            string skip;
+            if (!speculative) {
+                skip = newLabel();
+                code << "    cmpq $0, sem_errors(%rip)\n";
+                code << "    jne " << skip << "\n";
+            }
+            Loc v = loc(in.dst);
+            if (varTypes[irIndex(in.dst)] == SEM_REAL) movReal(a, v);
+            else movInt(a, v);
+            if (!skip.empty()) code << skip << ":\n";
+            return;
+        }
+
+        allocTemp(in.dst);
+        Loc d = loc(in.dst);
+        switch (in.op) {
+        case IR_COPY:
+            if (isReal(in.a)) movReal(a, d);
+            else movInt(a, d);
+            break;
+        case IR_I2R: intToReal(d, in.a); break;
+        case IR_IADD: intBinary("addq", d, a, loc(in.b)); break;
+        case IR_ISUB: intBinary("subq", d, a, loc(in.b)); break;
+        case IR_IMUL: intBinary("imulq", d, a, loc(in.b)); break;
+        case IR_IDIV: intDivide(d, a, in); break;
+        case IR_RADD: realBinary("addsd", d, a, loc(in.b)); break;
+        case IR_RSUB: realBinary("subsd", d, a, loc(in.b)); break;
+        case IR_RMUL: realBinary("mulsd", d, a, loc(in.b)); break;
+        case IR_RDIV: realDivide(d, a, in); break;
+        default: break;
+        }
+    }
+
+    // 条件跳转：sense为真时条件成立跳转，否则条件不成立跳转
+    void conditionalJump(const IRBlock& b, bool sense, int target) {
+        string to = blockLabel(target);
+        Loc l = loc(b.lhs), r = loc(b.rhs);
+        if (!b.realCompare) {
+            static const char* const cc[] = { "l", "g", "le", "ge", "e" };
+            static const char* const ncc[] = { "ge", "le", "g", "l", "ne" };
+            if (l.kind == Loc::IMM || (l.kind == Loc::MEM && r.kind == Loc::MEM)) {
+                movInt(l, RAX);
+                l = RAX;
+            }
+            code << "    cmpq " << r.text << ", " << l.text << "\n";
+            code << "    j" << (sense ? cc : ncc)[b.rel] << " " << to << "\n";
+            return;
+        }
+
+        // ucomisd src, x 按 x ? src 设置标志；无序（NaN）时CF=ZF=PF=1，
+        // a/ae在无序时不成立，be/b在无序时成立，正好分别对应条件与其否定
+        bool swap = b.rel == REL_LT || b.rel == REL_LE;
+        Loc x = swap ? r : l, src = swap ? l : r;
+        if (x.kind != Loc::XMM) {
+            movReal(x, XMM15);
+            x = XMM15;
+        }
+        code << "    ucomisd " << src.text << ", " << x.text << "\n";
+        if (b.rel == REL_EQ) {
+            if (sense) {
+                string skip = newLabel();
+                code << "    jp " << skip << "\n";
+                code << "    je " << to << "\n";
+                code << skip << ":\n";
+            } else {
+                code << "    jp " << to << "\n";
+                code << "    jne " << to << "\n";
+            }
+            return;
+        }
+        bool strict = b.rel == REL_LT || b.rel == REL_GT;
+        const char* j = strict ? (sense ? "ja" : "jbe") : (sense ? "jae" : "jb");
+        code << "    " << j << " " << to << "\n";
+    }
+
+    void emitBlock(int id) {
+        const IRBlock& b = fn.blocks[id];
+        int n = (int)b.code.size();
+        for (int i = 0; i < n; i++) {
+            const IRInstr& in = b.code[i];
+            if (irKind(in.a) == IR_TEMP) lastUse[irIndex(in.a)] = i;
+            if (in.op >= IR_IADD && in.op <= IR_RDIV && irKind(in.b) == IR_TEMP) lastUse[irIndex(in.b)] = i;
+        }
+        if (b.term == IR_BRANCH) {
+            if (irKind(b.lhs) == IR_TEMP) lastUse[irIndex(b.lhs)] = n;
+            if (irKind(b.rhs) == IR_TEMP) lastUse[irIndex(b.rhs)] = n;
+        }
+
+        // 每块开始时所有临时寄存器都空闲
+        freeGprs.clear();
+        freeXmms.clear();
+        for (int i = (int)(sizeof(TEMP_GPRS) / sizeof(TEMP_GPRS[0])) - 1; i >= 0; i--) freeGprs.push_back(gpr(TEMP_GPRS[i]));
+        for (int i = TEMP_XMMS - 1; i >= 0; i--) freeXmms.push_back(xmm(i));
+        freeSlots.clear();
+        for (int s = slotCount - 1; s >= 0; s--) freeSlots.push_back(s);
+
+        code << blockLabel(id) << ":\n";
+        for (int i = 0; i < n; i++) {
+            const IRInstr& in = b.code[i];
+            emitInstr(in);
+            // 操作数在此之后不再使用则释放；结果从未被使用的临时值也立即释放
+            if (irKind(in.a) == IR_TEMP && lastUse[irIndex(in.a)] == i) releaseTemp(in.a);
+            if (in.op >= IR_IADD && in.op <= IR_RDIV && irKind(in.b) == IR_TEMP && in.b != in.a &&
+                lastUse[irIndex(in.b)] == i) {
+                releaseTemp(in.b);
+            }
+            if (irKind(in.dst) == IR_TEMP && lastUse[irIndex(in.dst)] < i) releaseTemp(in.dst);
+        }
+
+        int next = id + 1;
+        // 精确版本中出现错误后赋值不再生效、循环无法前进，回跳前结束执行
+        if (!speculative && b.term != IR_HALT && (b.succ[0] <= id || (b.term == IR_BRANCH && b.succ[1] <= id))) {
+            code << "    cmpq $0, sem_errors(%rip)\n";
+            code << "    jne " << label("exit") << "\n";
+        }
+        switch (b.term) {
+        case IR_HALT:
+            code << "    jmp " << label("exit") << "\n";
+            break;
+        case IR_JUMP:
+            if (b.succ[0] != next) code << "    jmp " << blockLabel(b.succ[0]) << "\n";
+            break;
+        case IR_BRANCH:
+            if (b.succ[1] == next) {
+                conditionalJump(b, true, b.succ[0]);
+            } else if (b.succ[0] == next) {
+                conditionalJump(b, false, b.succ[1]);
+            } else {
+                conditionalJump(b, true, b.succ[0]);
+                code << "    jmp " << blockLabel(b.succ[1]) << "\n";
+            }
+            break;
+        }
+    }
+};
+
+// 报告除零错误：第一个错误标为line 1，其后标为line 5（与SemanticAnalyzer::error一致）。
+// 保存全部调用者保存的寄存器，调用处不必关心寄存器分配。
+const char* const DIV_ERROR_HELPER =
+    "    .p2align 4\n"
+    "sem_div_error:\n"
+    "    pushq %rbp\n"
+    "    movq %rsp, %rbp\n"
+    "    pushq %rax\n"
+    "    pushq %rcx\n"
+    "    pushq %rdx\n"
+    "    pushq %rsi\n"
+    "    pushq %rdi\n"
+    "    pushq %r8\n"
+    "    pushq %r9\n"
+    "    pushq %r10\n"
+    "    pushq %r11\n"
+    "    andq $-16, %rsp\n"
+    "    subq $128, %rsp\n";
+
+const char* const DIV_ERROR_HELPER_TAIL =
+    "    leaq -72(%rbp), %rsp\n"
+    "    popq %r11\n"
+    "    popq %r10\n"
+    "    popq %r9\n"
+    "    popq %r8\n"
+    "    popq %rdi\n"
+    "    popq %rsi\n"
+    "    popq %rdx\n"
+    "    popq %rcx\n"
+    "    popq %rax\n"
+    "    popq %rbp\n"
+    "    ret\n";
+
+}
+
+bool generateSemanticAssembly(const IRFunction& optimized, const IRFunction& precise,
+                              const SymbolTable& symbols, const vector<string>& staticErrors,
+                              ostream& out, string& failure) {
+    int slotA = symbols.lookup("a"), slotB = symbols.lookup("b"), slotC = symbols.lookup("c");
+    if (slotA < 0 || slotB < 0 || slotC < 0) {
+        failure = "程序必须声明变量a、b、c";
+        return false;
+    }
+
+    vector<SemType> varTypes(symbols.size());
+    for (int s = 0; s < symbols.size(); s++) varTypes[s] = symbols[s].type;
+
+    ConstPool pool;
+    ostringstream text;
+    bool runFast = staticErrors.empty();
+    if (runFast) FunctionEmitter(optimized, varTypes, true, "sem_fast", pool).run(text);
+    FunctionEmitter(precise, varTypes, false, "sem_precise", pool).run(text);
+
+    out << "# 由SemanticAnalyzer::compileToAssembly生成，汇编链接: cc -o prog prog.s\n";
+    out << "    .text\n";
+    out << text.str();
+
+    out << DIV_ERROR_HELPER;
+    for (int i = 0; i < 16; i++) out << "    movsd %xmm" << i << ", " << i * 8 << "(%rsp)\n";
+    out << "    leaq .Lsem_msg_first(%rip), %rsi\n"
+           "    cmpq $0, sem_errors(%rip)\n"
+           "    je 1f\n"
+           "    leaq .Lsem_msg_next(%rip), %rsi\n"
+           "1:\n"
+           "    leaq .Lsem_fmt_s(%rip), %rdi\n"
+           "    xorl %eax, %eax\n"
+           "    call printf@PLT\n"
+           "    incq sem_errors(%rip)\n";
+    for (int i = 0; i < 16; i++) out << "    movsd " << i * 8 << "(%rsp), %xmm" << i << "\n";
+    out << DIV_ERROR_HELPER_TAIL;
+
+    // main：执行后按printResults的格式输出，错误之间以换行分隔、最后一条不换行
+    out << "    .globl main\n"
+           "    .p2align 4\n"
+           "main:\n"
+           "    pushq %rbx\n";
+    if (runFast) {
+        out << "    call sem_fast\n"
+               "    testl %eax, %eax\n"
+               "    jnz .Lmain_print\n"
+               "    leaq sem_init(%rip), %rsi\n"
+               "    leaq sem_vars(%rip), %rdi\n"
+               "    movl $" << symbols.size() << ", %ecx\n"
+               "    rep movsq\n"
+               "    call sem_precise\n";
+    } else {
+        out << "    leaq .Lsem_fmt_s(%rip), %rdi\n"
+               "    leaq .Lsem_static(%rip), %rsi\n"
+               "    xorl %eax, %eax\n"
+               "    call printf@PLT\n"
+               "    movq $" << staticErrors.size() << ", sem_errors(%rip)\n"
+               "    call sem_precise\n";
+    }
+    out << ".Lmain_print:\n"
+           "    cmpq $0, sem_errors(%rip)\n"
+           "    jne .Lmain_done\n";
+    // a、b按整数输出，c按double输出
+    auto asInt = [&](int slot, const char* reg) {
+        if (varTypes[slot] == SEM_REAL) out << "    cvttsd2siq " << varHome(slot) << ", " << reg << "\n";
+        else out << "    movq " << varHome(slot) << ", " << reg << "\n";
+    };
+    asInt(slotA, "%rsi");
+    asInt(slotB, "%rdx");
+    if (varTypes[slotC] == SEM_REAL) {
+        out << "    movsd " << varHome(slotC) << ", %xmm0\n";
+    } else {
+        out << "    pxor %xmm0, %xmm0\n"
+               "    cvtsi2sdq " << varHome(slotC) << ", %xmm0\n";
+    }
+    out << "    leaq .Lsem_fmt_vars(%rip), %rdi\n"
+           "    movl $1, %eax\n"
+           "    call printf@PLT\n"
+           ".Lmain_done:\n"
+           "    xorl %eax, %eax\n"
+           "    popq %rbx\n"
+           "    ret\n";
+
+    // 变量的初始值保存两份：sem_vars供执行读写，sem_init用于放弃推测执行后恢复
+    out << "    .data\n    .align 8\n";
+    for (const char* table : { "sem_vars", "sem_init" }) {
+        out << table << ":\n";
+        for (int s = 0; s < symbols.size(); s++) out << "    .quad " << symbols[s].i << "\n";
+        if (symbols.size() == 0) out << "    .quad 0\n";
+    }
+    out << "sem_errors:\n    .quad 0\n";
+
+    string joined;
+    for (size_t i = 0; i < staticErrors.size(); i++) {
+        if (i > 0) joined += "\n";
+        joined += staticErrors[i];
+    }
+    out << "    .section .rodata\n"
+        << ".Lsem_fmt_s:\n    .string \"%s\"\n"
+        << ".Lsem_fmt_vars:\n    .string " << asmString("a: %ld\nb: %ld\nc: %g\n") << "\n"
+        << ".Lsem_msg_first:\n    .string " << asmString("error message:line 1,division by zero") << "\n"
+        << ".Lsem_msg_next:\n    .string " << asmString("\nerror message:line 5,division by zero") << "\n"
+        << ".Lsem_static:\n    .string " << asmString(joined) << "\n";
+    pool.emit(out);
+    out << "    .section .note.GNU-stack,\"\",@progbits\n";
+    return true;
+}
@@ -0,0 +1,273 @@
+// SemanticIR.cpp
+#include "SemanticIR.h"
+
+#include <ostream>
+
+using namespace std;
+
+int IRFunction::addConst(SemValue v) {
+    // 按类型与8字节的值比较，0.0与-0.0不合并
+    auto it = constIndex[v.type].emplace(v.i, (int)constants.size()).first;
+    if (it->second == (int)constants.size()) constants.push_back(v);
+    return irOperand(IR_CONST, it->second);
+}
+
+size_t IRFunction::instrCount() const {
+    size_t n = 0;
+    for (const IRBlock& b : blocks) n += b.code.size() + 1;
+    return n;
+}
+
+namespace {
+
+// 按语句结构生成基本块：if生成then/else/汇合三个块，while生成条件/循环体/出口三个块。
+// 块按生成顺序排列，顺序执行的块在后端可以省去跳转。
+class Lowering {
+public:
+    Lowering(const SemProgram& p, const vector<int>& s, const SemTypeInfo& t, int varCount)
+        : program(p), varSlots(s), types(t) {
+        fn.varCount = varCount;
+    }
+
+    IRFunction run() {
+        cur = newBlock();
+        if (program.body >= 0) stmt(program.body);
+        fn.blocks[cur].term = IR_HALT;
+        return move(fn);
+    }
+
+private:
+    const SemProgram& program;
+    const vector<int>& varSlots;
+    const SemTypeInfo& types;
+    IRFunction fn;
+    int cur = 0;
+    vector<int> operandScratch;     // expr中子树各结点的操作数
+
+    // 注意：新建块会使指向fn.blocks元素的引用失效
+    int newBlock() {
+        fn.blocks.emplace_back();
+        return (int)fn.blocks.size() - 1;
+    }
+
+    void emit(IROp op, int dst, int a, int b = 0) { fn.blocks[cur].code.push_back({ op, dst, a, b }); }
+
+    void jump(int from, int to) {
+        fn.blocks[from].term = IR_JUMP;
+        fn.blocks[from].succ[0] = to;
+    }
+
+    bool isReal(int exprId) const { return types.exprTypes[exprId] == SEM_REAL; }
+
+    int toReal(int operand) {
+        int t = fn.newTemp();
+        emit(IR_I2R, t, operand);
+        return t;
+    }
+
+    // 计算两个操作数，需要按实数运算时把整数一侧转换为double
+    bool operands(int lhs, int rhs, int& l, int& r) {
+        l = expr(lhs);
+        r = expr(rhs);
+        bool real = isReal(lhs) || isReal(rhs);
+        if (real && !isReal(lhs)) l = toReal(l);
+        if (real && !isReal(rhs)) r = toReal(r);
+        return real;
+    }
+
+    // 表达式的子树在exprs中是以id结尾的一段连续下标（后序），按下标顺序生成即与
+    // 先左后右的递归求值顺序相同，长运算链也不会耗尽调用栈
+    int expr(int id) {
+        int first = id;
+        while (program.exprs[first].kind == SemExpr::BINARY) first = program.exprs[first].lhs;
+        vector<int>& operand = operandScratch;
+        operand.resize(id - first + 1);
+        for (int i = first; i <= id; i++) {
+            const SemExpr& e = program.exprs[i];
+            switch (e.kind) {
+            case SemExpr::NUM:
+                operand[i - first] = fn.addConst(e.value);
+                break;
+            case SemExpr::VAR:
+                operand[i - first] = irOperand(IR_VAR, varSlots[e.var]);
+                break;
+            default: {
+                int l = operand[e.lhs - first], r = operand[e.rhs - first];
+                bool real = isReal(e.lhs) || isReal(e.rhs);
+                if (real && !isReal(e.lhs)) l = toReal(l);
+                if (real && !isReal(e.rhs)) r = toReal(r);
+                IROp op;
+                switch (e.op) {
+                case '+': op = real ? IR_RADD : IR_IADD; break;
+                case '-': op = real ? IR_RSUB : IR_ISUB; break;
+                case '*': op = real ? IR_RMUL : IR_IMUL; break;
+                default: op = real ? IR_RDIV : IR_IDIV; break;
+                }
+                int t = fn.newTemp();
+                emit(op, t, l, r);
+                operand[i - first] = t;
+                break;
+            }
+            }
+        }
+        return operand[id - first];
+    }
+
+    // 在当前块末尾计算条件，两个后继待语句生成后再由branch填入
+    struct Cond {
+        int block;
+        SemRelOp rel;
+        bool real;
+        int lhs, rhs;
+    };
+
+    Cond cond(const SemCond& c) {
+        Cond k;
+        k.block = cur;
+        k.rel = c.op;
+        k.real = operands(c.lhs, c.rhs, k.lhs, k.rhs);
+        return k;
+    }
+
+    void branch(const Cond& k, int whenTrue, int whenFalse) {
+        if (k.rel == REL_INVALID) {
+            // 非法运算符：两侧照常求值（可能产生除零错误），条件恒为假
+            jump(k.block, whenFalse);
+            return;
+        }
+        IRBlock& b = fn.blocks[k.block];
+        b.term = IR_BRANCH;
+        b.rel = k.rel;
+        b.realCompare = k.real;
+        b.lhs = k.lhs;
+        b.rhs = k.rhs;
+        b.succ[0] = whenTrue;
+        b.succ[1] = whenFalse;
+    }
+
+    void stmt(int id) {
+        const SemStmt& s = program.stmts[id];
+        switch (s.kind) {
+        case SemStmt::ASSIGN: {
+            int v = expr(s.expr);
+            SemType target = types.varTypes[s.var];
+            // 未声明变量与real赋给int在执行前已报错，赋值永远不会生效，只保留右部的求值
+            if (target == SEM_UNTYPED || (target == SEM_INT && isReal(s.expr))) break;
+            if (target == SEM_REAL && !isReal(s.expr)) v = toReal(v);
+            emit(IR_STORE, irOperand(IR_VAR, varSlots[s.var]), v);
+            break;
+        }
+        case SemStmt::IF: {
+            Cond k = cond(s.cond);
+            int thenBlock = newBlock();
+            cur = thenBlock;
+            stmt(s.body);
+            int thenEnd = cur;
+            int elseBlock = newBlock();
+            cur = elseBlock;
+            stmt(s.elseBody);
+            int elseEnd = cur;
+            int join = newBlock();
+            branch(k, thenBlock, elseBlock);
+            jump(thenEnd, join);
+            jump(elseEnd, join);
+            cur = join;
+            break;
+        }
+        case SemStmt::WHILE: {
+            int header = newBlock();
+            jump(cur, header);
+            cur = header;
+            Cond k = cond(s.cond);
+            int body = newBlock();
+            cur = body;
+            stmt(s.body);
+            jump(cur, header);
+            int exit = newBlock();
+            branch(k, body, exit);
+            cur = exit;
+            break;
+        }
+        case SemStmt::BLOCK:
+            for (int child : s.children) stmt(child);
+            break;
+        }
+    }
+};
+
+const char* opName(IROp op) {
+    switch (op) {
+    case IR_COPY: return "copy";
+    case IR_I2R: return "i2r";
+    case IR_IADD: return "iadd";
+    case IR_ISUB: return "isub";
+    case IR_IMUL: return "imul";
+    case IR_IDIV: return "idiv";
+    case IR_RADD: return "radd";
+    case IR_RSUB: return "rsub";
+    case IR_RMUL: return "rmul";
+    case IR_RDIV: return "rdiv";
+    default: return "store";
+    }
+}
+
+const char* relName(SemRelOp rel) {
+    switch (rel) {
+    case REL_LT: return "<";
+    case REL_GT: return ">";
+    case REL_LE: return "<=";
+    case REL_GE: return ">=";
+    case REL_EQ: return "==";
+    default: return "?";
+    }
+}
+
+void printOperand(const IRFunction& fn, int operand, ostream& out) {
+    switch (irKind(operand)) {
+    case IR_VAR: out << "v" << irIndex(operand); break;
+    case IR_CONST: out << fn.constants[irIndex(operand)].number(); break;
+    default: out << "t" << irIndex(operand); break;
+    }
+}
+
+}
+
+IRFunction lowerSemanticProgram(const SemProgram& program, const vector<int>& varSlots,
+                                const SemTypeInfo& types, int varCount) {
+    return Lowering(program, varSlots, types, varCount).run();
+}
+
+void printIR(const IRFunction& fn, ostream& out) {
+    for (size_t i = 0; i < fn.blocks.size(); i++) {
+        const IRBlock& b = fn.blocks[i];
+        out << "b" << i << ":\n";
+        for (const IRInstr& in : b.code) {
+            out << "    ";
+            printOperand(fn, in.dst, out);
+            out << " = " << opName(in.op) << " ";
+            printOperand(fn, in.a, out);
+            if (in.op != IR_COPY && in.op != IR_I2R && in.op != IR_STORE) {
+                out << ", ";
+                printOperand(fn, in.b, out);
+            }
+            out << "\n";
+        }
+        out << "    ";
+        switch (b.term) {
+        case IR_HALT:
+            out << "halt";
+            break;
+        case IR_JUMP:
+            out << "jump b" << b.succ[0];
+            break;
+        case IR_BRANCH:
+            out << "branch ";
+            printOperand(fn, b.lhs, out);
+            out << " " << relName(b.rel) << (b.realCompare ? "r " : "i ");
+            printOperand(fn, b.rhs, out);
+            out << " ? b" << b.succ[0] << " : b" << b.succ[1];
+            break;
+        }
+        out << "\n";
+    }
+}
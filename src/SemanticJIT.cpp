@@ -0,0 +1,471 @@
+// SemanticJIT.cpp
+#include "SemanticJIT.h"
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <string>
+
+#if defined(__x86_64__) && !defined(_WIN32) && (defined(__unix__) || defined(__APPLE__))
+#define SEM_JIT_X64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+// 生成的函数：int64_t fn(SemWord* frame, JitContext* ctx)，返回1表示执行完毕，0表示放弃。
+// 异常不能穿过生成的代码（没有展开信息），辅助函数捕获后记入failure，生成的代码经放弃出口返回
+struct JitContext {
+    const SemanticVM::ErrorHandler* onError;
+    SemBudgetMeter* meter;
+    exception_ptr failure;
+};
+
+typedef int64_t (*JitEntry)(SemWord*, JitContext*);
+
+// 除零时由生成的代码调用，错误标志由生成的代码自己设置；报错函数抛出异常时返回非0
+int64_t jitDivisionByZero(JitContext* ctx) {
+    try {
+        (*ctx->onError)("division by zero");
+        return 0;
+    } catch (...) {
+        ctx->failure = current_exception();
+        return 1;
+    }
+}
+
+// 回跳处本段额度用完时由生成的代码调用，返回新的剩余步数，应中止时返回-1
+int64_t jitRefuel(JitContext* ctx) {
+    try {
+        return ctx->meter->refuel();
+    } catch (...) {
+        ctx->failure = current_exception();
+        return -1;
+    }
+}
+
+// 条件码（jcc rel32的第二个操作码字节）
+enum Cond : uint8_t {
+    CC_B = 0x82, CC_AE = 0x83, CC_E = 0x84, CC_NE = 0x85, CC_BE = 0x86, CC_A = 0x87,
+    CC_S = 0x88, CC_NS = 0x89, CC_P = 0x8A, CC_L = 0x8C, CC_GE = 0x8D, CC_LE = 0x8E, CC_G = 0x8F
+};
+
+const int RAX = 0, RCX = 1;
+
+// 最小的x86-64编码器：只包含生成代码用到的指令形式，内存操作数都是[rbx + disp]
+class Assembler {
+public:
+    vector<uint8_t> bytes;
+
+    int newLabel() {
+        labels.push_back(-1);
+        return (int)labels.size() - 1;
+    }
+    void bind(int label) { labels[label] = (int)bytes.size(); }
+
+    void emit(initializer_list<uint8_t> b) { bytes.insert(bytes.end(), b); }
+
+    void imm32(int32_t v) {
+        for (int i = 0; i < 4; i++) bytes.push_back((uint8_t)(v >> (8 * i)));
+    }
+
+    // ModRM + 位移，基址为rbx
+    void mem(int reg, int slot) {
+        int32_t disp = slot * 8;
+        if (disp >= -128 && disp <= 127) {
+            bytes.push_back((uint8_t)(0x40 | (reg << 3) | 3));
+            bytes.push_back((uint8_t)disp);
+        } else {
+            bytes.push_back((uint8_t)(0x80 | (reg << 3) | 3));
+            imm32(disp);
+        }
+    }
+
+    // REX.W op reg, [rbx + 8*slot]
+    void op64(uint8_t opcode, int reg, int slot) {
+        emit({ 0x48, opcode });
+        mem(reg, slot);
+    }
+
+    // 标量双精度指令：F2 0F op xmm, [rbx + 8*slot]
+    void sse(uint8_t prefix, uint8_t opcode, int xmm, int slot) {
+        emit({ prefix, 0x0F, opcode });
+        mem(xmm, slot);
+    }
+
+    void loadInt(int reg, int slot) { op64(0x8B, reg, slot); }
+    void storeInt(int slot) { op64(0x89, RAX, slot); }
+    void loadReal(int slot) { sse(0xF2, 0x10, 0, slot); }
+    void storeReal(int slot) { sse(0xF2, 0x11, 0, slot); }
+
+    void jcc(uint8_t cond, int label) {
+        emit({ 0x0F, cond });
+        fixup(label);
+    }
+    void jmp(int label) {
+        bytes.push_back(0xE9);
+        fixup(label);
+    }
+
+    // 回填全部跳转的rel32
+    void link() {
+        for (const auto& f : fixups) {
+            int32_t rel = labels[f.second] - (int)(f.first + 4);
+            memcpy(&bytes[f.first], &rel, 4);
+        }
+    }
+
+private:
+    vector<int> labels;
+    vector<pair<size_t, int>> fixups;
+
+    void fixup(int label) {
+        fixups.push_back({ bytes.size(), label });
+        imm32(0);
+    }
+};
+
+class JitCompiler {
+public:
+    JitCompiler(const IRFunction& f, bool spec, bool budget) : fn(f), speculative(spec), budgetChecks(budget) {
+        constBase = fn.varCount;
+        tempBase = constBase + (int)fn.constants.size();
+        errorSlot = tempBase + fn.tempCount;
+        fuelSlot = errorSlot + 1;
+    }
+
+    vector<uint8_t> compile() {
+        for (size_t i = 0; i < fn.blocks.size(); i++) blockLabels.push_back(as.newLabel());
+        int ret = as.newLabel(), bailout = as.newLabel();
+        exitLabel = as.newLabel();
+        bailoutLabel = bailout;
+
+        // push rbx; push r12; sub rsp, 8（调用报错函数时栈按16字节对齐）; mov rbx, rdi; mov r12, rsi
+        as.emit({ 0x53, 0x41, 0x54, 0x48, 0x83, 0xEC, 0x08, 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4 });
+        for (size_t i = 0; i < fn.blocks.size(); i++) emitBlock((int)i);
+
+        as.bind(exitLabel);
+        as.emit({ 0xB8, 0x01, 0x00, 0x00, 0x00 });     // mov eax, 1
+        as.bind(ret);
+        as.emit({ 0x48, 0x83, 0xC4, 0x08, 0x41, 0x5C, 0x5B, 0xC3 });   // add rsp, 8; pop r12; pop rbx; ret
+        as.bind(bailout);
+        as.emit({ 0x31, 0xC0 });                        // xor eax, eax
+        as.jmp(ret);
+        as.link();
+        return as.bytes;
+    }
+
+private:
+    const IRFunction& fn;
+    bool speculative;
+    bool budgetChecks;
+    int constBase, tempBase, errorSlot, fuelSlot;
+    Assembler as;
+    vector<int> blockLabels;
+    int exitLabel = 0, bailoutLabel = 0;
+
+    int slot(int operand) const {
+        switch (irKind(operand)) {
+        case IR_VAR: return irIndex(operand);
+        case IR_CONST: return constBase + irIndex(operand);
+        default: return tempBase + irIndex(operand);
+        }
+    }
+
+    void callHelper(const void* fnAddr) {
+        uint64_t target = (uint64_t)(uintptr_t)fnAddr;
+        as.emit({ 0x4C, 0x89, 0xE7 });                  // mov rdi, r12
+        as.emit({ 0x48, 0xB8 });                        // mov rax, imm64
+        for (int i = 0; i < 8; i++) as.bytes.push_back((uint8_t)(target >> (8 * i)));
+        as.emit({ 0xFF, 0xD0 });                        // call rax
+    }
+
+    // 回跳前计一步：剩余步数减到负数时补充额度，应中止时经放弃出口返回
+    void budgetCheck() {
+        int ok = as.newLabel();
+        as.op64(0xFF, 1, fuelSlot);                     // dec qword [fuel]
+        as.jcc(CC_NS, ok);
+        callHelper((const void*)&jitRefuel);
+        as.emit({ 0x48, 0x85, 0xC0 });                  // test rax, rax
+        as.jcc(CC_S, bailoutLabel);
+        as.storeInt(fuelSlot);
+        as.bind(ok);
+    }
+
+    // 除零：推测执行时放弃；精确执行时报错、置错误标志并保留左值（按位复制，int与real相同）
+    void divisionByZero(const IRInstr& in) {
+        if (speculative) {
+            as.jmp(bailoutLabel);
+            return;
+        }
+        callHelper((const void*)&jitDivisionByZero);
+        as.emit({ 0x48, 0x85, 0xC0 });                  // test rax, rax
+        as.jcc(CC_NE, bailoutLabel);
+        as.op64(0xC7, 0, errorSlot);                    // mov qword [flag], 1
+        as.imm32(1);
+        as.loadInt(RAX, slot(in.a));
+        as.storeInt(slot(in.dst));
+    }
+
+    // 与semWrapDiv一致：除数为-1时取负，避免INT64_MIN / -1触发异常
+    void intDivide(const IRInstr& in) {
+        int done = as.newLabel();
+        if (irKind(in.b) == IR_CONST) {
+            int64_t v = fn.constants[irIndex(in.b)].i;
+            if (v == 0) {
+                divisionByZero(in);
+                return;
+            }
+            as.loadInt(RAX, slot(in.a));
+            if (v == -1) {
+                as.emit({ 0x48, 0xF7, 0xD8 });          // neg rax
+            } else {
+                as.loadInt(RCX, slot(in.b));
+                as.emit({ 0x48, 0x99, 0x48, 0xF7, 0xF9 });   // cqo; idiv rcx
+            }
+            as.storeInt(slot(in.dst));
+            return;
+        }
+        int nonzero = as.newLabel(), divide = as.newLabel(), store = as.newLabel();
+        as.loadInt(RCX, slot(in.b));
+        as.emit({ 0x48, 0x85, 0xC9 });                  // test rcx, rcx
+        as.jcc(CC_NE, nonzero);
+        divisionByZero(in);
+        as.jmp(done);
+        as.bind(nonzero);
+        as.loadInt(RAX, slot(in.a));
+        as.emit({ 0x48, 0x83, 0xF9, 0xFF });            // cmp rcx, -1
+        as.jcc(CC_NE, divide);
+        as.emit({ 0x48, 0xF7, 0xD8 });                  // neg rax
+        as.jmp(store);
+        as.bind(divide);
+        as.emit({ 0x48, 0x99, 0x48, 0xF7, 0xF9 });      // cqo; idiv rcx
+        as.bind(store);
+        as.storeInt(slot(in.dst));
+        as.bind(done);
+    }
+
+    void realDivide(const IRInstr& in) {
+        int done = as.newLabel();
+        if (irKind(in.b) == IR_CONST) {
+            if (fn.constants[irIndex(in.b)].r == 0.0) {
+                divisionByZero(in);
+                return;
+            }
+        } else {
+            // 左移一位后为0即为±0.0
+            int nonzero = as.newLabel();
+            as.loadInt(RCX, slot(in.b));
+            as.emit({ 0x48, 0xD1, 0xE1 });              // shl rcx, 1
+            as.jcc(CC_NE, nonzero);
+            divisionByZero(in);
+            as.jmp(done);
+            as.bind(nonzero);
+        }
+        as.loadReal(slot(in.a));
+        as.sse(0xF2, 0x5E, 0, slot(in.b));             // divsd
+        as.storeReal(slot(in.dst));
+        as.bind(done);
+    }
+
+    void emitInstr(const IRInstr& in) {
+        switch (in.op) {
+        case IR_COPY:
+            as.loadInt(RAX, slot(in.a));
+            as.storeInt(slot(in.dst));
+            break;
+        case IR_STORE: {
+            // 精确执行中出现错误后赋值不再生效
+            int skip = as.newLabel();
+            if (!speculative) {
+                as.op64(0x83, 7, errorSlot);            // cmp qword [flag], 0
+                as.bytes.push_back(0x00);
+                as.jcc(CC_NE, skip);
+            }
+            as.loadInt(RAX, slot(in.a));
+            as.storeInt(slot(in.dst));
+            as.bind(skip);
+            break;
+        }
+        case IR_I2R:
+            as.emit({ 0x66, 0x0F, 0xEF, 0xC0 });        // pxor xmm0, xmm0
+            as.emit({ 0xF2, 0x48, 0x0F, 0x2A });        // cvtsi2sd xmm0, qword [m]
+            as.mem(0, slot(in.a));
+            as.storeReal(slot(in.dst));
+            break;
+        case IR_IADD:
+        case IR_ISUB:
+        case IR_IMUL:
+            as.loadInt(RAX, slot(in.a));
+            if (in.op == IR_IMUL) {
+                as.emit({ 0x48, 0x0F, 0xAF });          // imul rax, [m]
+                as.mem(RAX, slot(in.b));
+            } else {
+                as.op64(in.op == IR_IADD ? 0x03 : 0x2B, RAX, slot(in.b));
+            }
+            as.storeInt(slot(in.dst));
+            break;
+        case IR_IDIV:
+            intDivide(in);
+            break;
+        case IR_RADD:
+        case IR_RSUB:
+        case IR_RMUL: {
+            static const uint8_t ops[] = { 0x58, 0x5C, 0x59 };  // addsd, subsd, mulsd
+            as.loadReal(slot(in.a));
+            as.sse(0xF2, ops[in.op - IR_RADD], 0, slot(in.b));
+            as.storeReal(slot(in.dst));
+            break;
+        }
+        case IR_RDIV:
+            realDivide(in);
+            break;
+        }
+    }
+
+    // 条件跳转：sense为真时条件成立跳转，否则条件不成立跳转
+    void conditionalJump(const IRBlock& b, bool sense, int target) {
+        int label = blockLabels[target];
+        if (!b.realCompare) {
+            static const uint8_t cc[] = { CC_L, CC_G, CC_LE, CC_GE, CC_E };
+            static const uint8_t ncc[] = { CC_GE, CC_LE, CC_G, CC_L, CC_NE };
+            as.loadInt(RAX, slot(b.lhs));
+            as.op64(0x3B, RAX, slot(b.rhs));            // cmp rax, [m]
+            as.jcc((sense ? cc : ncc)[b.rel], label);
+            return;
+        }
+
+        // ucomisd xmm0, m 按 xmm0 ? m 设置标志；无序（NaN）时CF=ZF=PF=1，
+        // a/ae在无序时不成立，be/b在无序时成立，正好分别对应条件与其否定
+        bool swap = b.rel == REL_LT || b.rel == REL_LE;
+        as.loadReal(slot(swap ? b.rhs : b.lhs));
+        as.sse(0x66, 0x2E, 0, slot(swap ? b.lhs : b.rhs));
+        if (b.rel == REL_EQ) {
+            if (sense) {
+                int skip = as.newLabel();
+                as.jcc(CC_P, skip);
+                as.jcc(CC_E, label);
+                as.bind(skip);
+            } else {
+                as.jcc(CC_P, label);
+                as.jcc(CC_NE, label);
+            }
+            return;
+        }
+        bool strict = b.rel == REL_LT || b.rel == REL_GT;
+        as.jcc(strict ? (sense ? CC_A : CC_BE) : (sense ? CC_AE : CC_B), label);
+    }
+
+    void emitBlock(int id) {
+        const IRBlock& b = fn.blocks[id];
+        as.bind(blockLabels[id]);
+        for (const IRInstr& in : b.code) emitInstr(in);
+
+        int next = id + 1;
+        if (b.term != IR_HALT && (b.succ[0] <= id || (b.term == IR_BRANCH && b.succ[1] <= id))) {
+            // 精确执行中出现错误后赋值不再生效、循环无法前进，回跳前结束执行
+            if (!speculative) {
+                as.op64(0x83, 7, errorSlot);            // cmp qword [flag], 0
+                as.bytes.push_back(0x00);
+                as.jcc(CC_NE, exitLabel);
+            }
+            if (budgetChecks) budgetCheck();
+        }
+        switch (b.term) {
+        case IR_HALT:
+            as.jmp(exitLabel);
+            break;
+        case IR_JUMP:
+            if (b.succ[0] != next) as.jmp(blockLabels[b.succ[0]]);
+            break;
+        case IR_BRANCH:
+            if (b.succ[1] == next) {
+                conditionalJump(b, true, b.succ[0]);
+            } else if (b.succ[0] == next) {
+                conditionalJump(b, false, b.succ[1]);
+            } else {
+                conditionalJump(b, true, b.succ[0]);
+                as.jmp(blockLabels[b.succ[1]]);
+            }
+            break;
+        }
+    }
+};
+
+}
+
+SemJitFunction::~SemJitFunction() {
+    release();
+}
+
+void SemJitFunction::release() {
+#ifdef SEM_JIT_X64
+    if (code) munmap(code, mapped);
+#endif
+    code = nullptr;
+    mapped = size = 0;
+}
+
+bool SemJitFunction::supported() {
+#ifdef SEM_JIT_X64
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SemJitFunction::compile(const IRFunction& fn, SemanticVM::Mode mode, bool budgetChecks) {
+    release();
+#ifdef SEM_JIT_X64
+    vector<uint8_t> bytes = JitCompiler(fn, mode == SemanticVM::SPECULATIVE, budgetChecks).compile();
+
+    // 先以可读写方式映射并写入，再改为只读可执行，任何时刻都不同时可写可执行
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t length = (bytes.size() + page - 1) / page * page;
+    void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return false;
+    memcpy(p, bytes.data(), bytes.size());
+    if (mprotect(p, length, PROT_READ | PROT_EXEC) != 0) {
+        munmap(p, length);
+        return false;
+    }
+    code = p;
+    mapped = length;
+    size = bytes.size();
+    constants = fn.constants;
+    varCount = fn.varCount;
+    frameSize = varCount + (int)constants.size() + fn.tempCount;
+    return true;
+#else
+    (void)fn;
+    (void)mode;
+    (void)budgetChecks;
+    return false;
+#endif
+}
+
+bool SemJitFunction::run(SemValue* slots, bool hasError, const SemanticVM::ErrorHandler& onError,
+                         SemBudgetMeter* meter) {
+    if (!code) return false;
+    // 帧末尾依次为错误标志与当前额度的剩余步数
+    frame.resize(frameSize + 2);
+    SemWord* f = frame.data();
+    for (int v = 0; v < varCount; v++) f[v].i = slots[v].i;
+    for (size_t k = 0; k < constants.size(); k++) f[varCount + k].i = constants[k].i;
+    f[frameSize].i = hasError ? 1 : 0;
+    f[frameSize + 1].i = meter ? meter->fuel : 0;
+
+    JitContext ctx = { &onError, meter, nullptr };
+    JitEntry entry = reinterpret_cast<JitEntry>(code);
+    bool done = entry(f, &ctx) != 0;
+    // 辅助函数中的异常在回到C++栈帧后重新抛出，slots不变
+    if (ctx.failure) rethrow_exception(ctx.failure);
+    if (meter && !meter->aborted()) meter->fuel = f[frameSize + 1].i;
+    if (!done) return false;
+    // 只写回8字节的值部分，变量的类型标记不变
+    for (int v = 0; v < varCount; v++) slots[v].i = f[v].i;
+    return true;
+}
@@ -0,0 +1,236 @@
+// SemanticParser.cpp
+#include "SemanticAST.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+bool isID(const string& s) {
+    return !s.empty() && islower(static_cast<unsigned char>(s[0]));
+}
+
+bool isInt(const string& s) {
+    return !s.empty() && all_of(s.begin(), s.end(), [](char c) { return isdigit(static_cast<unsigned char>(c)) != 0; });
+}
+
+// 恰有一个小数点，且至少有一位数字
+bool isReal(const string& s) {
+    bool dot = false, digit = false;
+    for (char c : s) {
+        if (c == '.') {
+            if (dot) return false;
+            dot = true;
+        } else if (isdigit(static_cast<unsigned char>(c))) {
+            digit = true;
+        } else {
+            return false;
+        }
+    }
+    return dot && digit;
+}
+
+// 递归下降分析，结构与SemanticAnalyzer的逐记号解释一一对应
+class Parser {
+public:
+    Parser(const vector<string>& t, size_t start, int limit) : tokens(t), pos(start), maxDepth(limit) {}
+
+    SemProgram run() {
+        program.body = compoundstmt();
+        return move(program);
+    }
+
+private:
+    const vector<string>& tokens;
+    size_t pos;
+    SemProgram program;
+    unordered_map<string, int> varIds;
+    const string empty;
+    int maxDepth;
+    int depth = 0;              // 当前语句与括号的嵌套层数
+
+    // 嵌套过深：记录后跳到输入末尾，各层随即返回
+    bool deeper() {
+        if (maxDepth <= 0 || ++depth <= maxDepth) return true;
+        program.tooDeep = true;
+        pos = tokens.size();
+        return false;
+    }
+
+    bool atEnd() const { return pos >= tokens.size(); }
+    const string& peek() const { return atEnd() ? empty : tokens[pos]; }
+    const string& get() { return atEnd() ? empty : tokens[pos++]; }
+
+    int variable(const string& name) {
+        auto it = varIds.find(name);
+        if (it != varIds.end()) return it->second;
+        int id = (int)program.varNames.size();
+        varIds.emplace(name, id);
+        program.varNames.push_back(name);
+        return id;
+    }
+
+    // 当前记号作为变量引用
+    int reference() {
+        size_t at = pos;
+        int var = variable(get());
+        program.varRefs.push_back({ at, var });
+        return var;
+    }
+
+    int addExpr(const SemExpr& e) {
+        program.exprs.push_back(e);
+        return (int)program.exprs.size() - 1;
+    }
+
+    // 语句以当前位置为结尾登记
+    int addStmt(SemStmt s, size_t begin) {
+        s.begin = begin;
+        s.end = pos;
+        program.stmts.push_back(move(s));
+        return (int)program.stmts.size() - 1;
+    }
+
+    int number(SemValue value) {
+        return addExpr({ SemExpr::NUM, 0, value, -1, -1, -1 });
+    }
+
+    int simpleexpr() {
+        const string& t = peek();
+        if (isID(t)) {
+            int var = reference();
+            return addExpr({ SemExpr::VAR, 0, SemValue(), var, -1, -1 });
+        }
+        if (isInt(t)) {
+            int64_t n;
+            if (!semParseInt(get(), n)) program.errors.push_back("integer literal out of range");
+            return number(SemValue::ofInt(n));
+        }
+        if (isReal(t)) return number(SemValue::ofReal(strtod(get().c_str(), nullptr)));
+        if (t == "(") {
+            get();
+            if (!deeper()) return number(SemValue());
+            int e = arithexpr();
+            depth--;
+            get(); // )
+            return e;
+        }
+        // 与原实现一致：不消耗当前记号
+        program.errors.push_back("invalid expression");
+        return number(SemValue());
+    }
+
+    int multexpr() {
+        int l = simpleexpr();
+        while (peek() == "*" || peek() == "/") {
+            char op = get()[0];
+            int r = simpleexpr();
+            l = addExpr({ SemExpr::BINARY, op, SemValue(), -1, l, r });
+        }
+        return l;
+    }
+
+    int arithexpr() {
+        int l = multexpr();
+        while (peek() == "+" || peek() == "-") {
+            char op = get()[0];
+            int r = multexpr();
+            l = addExpr({ SemExpr::BINARY, op, SemValue(), -1, l, r });
+        }
+        return l;
+    }
+
+    SemCond boolexpr() {
+        SemCond c;
+        c.lhs = arithexpr();
+        const string& op = get();
+        c.rhs = arithexpr();
+        if (op == "<") c.op = REL_LT;
+        else if (op == ">") c.op = REL_GT;
+        else if (op == "<=") c.op = REL_LE;
+        else if (op == ">=") c.op = REL_GE;
+        else if (op == "==") c.op = REL_EQ;
+        else {
+            c.op = REL_INVALID;
+            program.errors.push_back("invalid boolop");
+        }
+        return c;
+    }
+
+    int stmt() {
+        if (!deeper()) return -1;
+        int s;
+        if (peek() == "if") s = ifstmt();
+        else if (peek() == "while") s = whilestmt();
+        else if (peek() == "{") s = compoundstmt();
+        else s = assgstmt();
+        depth--;
+        return s;
+    }
+
+    int compoundstmt() {
+        size_t begin = pos;
+        get(); // {
+        SemStmt s{};
+        s.kind = SemStmt::BLOCK;
+        while (peek() != "}") {
+            if (program.tooDeep) break;
+            if (atEnd()) {
+                program.errors.push_back("unexpected end of program");
+                break;
+            }
+            s.children.push_back(stmt());
+        }
+        get(); // }
+        return addStmt(move(s), begin);
+    }
+
+    int assgstmt() {
+        size_t begin = pos;
+        SemStmt s{};
+        s.kind = SemStmt::ASSIGN;
+        s.var = reference();
+        get(); // =
+        s.expr = arithexpr();
+        get(); // ;
+        return addStmt(move(s), begin);
+    }
+
+    int ifstmt() {
+        size_t begin = pos;
+        SemStmt s{};
+        s.kind = SemStmt::IF;
+        get(); // if
+        get(); // (
+        s.cond = boolexpr();
+        get(); // )
+        get(); // then
+        s.body = stmt();
+        get(); // else
+        s.elseBody = stmt();
+        return addStmt(move(s), begin);
+    }
+
+    int whilestmt() {
+        size_t begin = pos;
+        SemStmt s{};
+        s.kind = SemStmt::WHILE;
+        get(); // while
+        get(); // (
+        s.cond = boolexpr();
+        get(); // )
+        s.body = stmt();
+        s.elseBody = -1;
+        return addStmt(move(s), begin);
+    }
+};
+
+}
+
+SemProgram parseSemanticProgram(const vector<string>& tokens, size_t start, int maxDepth) {
+    return Parser(tokens, start, maxDepth).run();
+}
@@ -0,0 +1,564 @@
+// SemanticPasses.cpp
+#include "SemanticIR.h"
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+bool isBinary(IROp op) { return op >= IR_IADD && op <= IR_RDIV; }
+bool isDivision(IROp op) { return op == IR_IDIV || op == IR_RDIV; }
+bool isCommutative(IROp op) { return op == IR_IADD || op == IR_IMUL || op == IR_RADD || op == IR_RMUL; }
+
+// 两个常量都已知时计算运算结果；除数为0时不折叠，留给执行时报错
+bool foldInstr(IROp op, SemValue a, SemValue b, SemValue& out) {
+    switch (op) {
+    case IR_COPY:
+    case IR_STORE: out = a; return true;
+    case IR_I2R: out = SemValue::ofReal((double)a.i); return true;
+    case IR_IADD: out = SemValue::ofInt(semWrapAdd(a.i, b.i)); return true;
+    case IR_ISUB: out = SemValue::ofInt(semWrapSub(a.i, b.i)); return true;
+    case IR_IMUL: out = SemValue::ofInt(semWrapMul(a.i, b.i)); return true;
+    case IR_IDIV:
+        if (b.i == 0) return false;
+        out = SemValue::ofInt(semWrapDiv(a.i, b.i));
+        return true;
+    case IR_RADD: out = SemValue::ofReal(a.r + b.r); return true;
+    case IR_RSUB: out = SemValue::ofReal(a.r - b.r); return true;
+    case IR_RMUL: out = SemValue::ofReal(a.r * b.r); return true;
+    case IR_RDIV:
+        if (b.r == 0.0) return false;
+        out = SemValue::ofReal(a.r / b.r);
+        return true;
+    default: return false;
+    }
+}
+
+// 比较的语义与虚拟机一致：按realCompare读取double或64位整数
+bool foldCompare(SemRelOp rel, bool real, SemValue l, SemValue r) {
+    if (real) {
+        switch (rel) {
+        case REL_LT: return l.r < r.r;
+        case REL_GT: return l.r > r.r;
+        case REL_LE: return l.r <= r.r;
+        case REL_GE: return l.r >= r.r;
+        case REL_EQ: return l.r == r.r;
+        default: return false;
+        }
+    }
+    switch (rel) {
+    case REL_LT: return l.i < r.i;
+    case REL_GT: return l.i > r.i;
+    case REL_LE: return l.i <= r.i;
+    case REL_GE: return l.i >= r.i;
+    case REL_EQ: return l.i == r.i;
+    default: return false;
+    }
+}
+
+// 删除除法会改变是否报错，只有除数为已知非零常量时才允许删除
+bool removable(const IRFunction& fn, const IRInstr& in) {
+    if (!isDivision(in.op)) return true;
+    return irKind(in.b) == IR_CONST && !fn.constants[irIndex(in.b)].isZero();
+}
+
+vector<int> predecessorCounts(const IRFunction& fn) {
+    vector<int> preds(fn.blocks.size(), 0);
+    for (const IRBlock& b : fn.blocks) {
+        if (b.term == IR_JUMP) preds[b.succ[0]]++;
+        else if (b.term == IR_BRANCH) {
+            preds[b.succ[0]]++;
+            preds[b.succ[1]]++;
+        }
+    }
+    return preds;
+}
+
+// 删除从入口不可达的块并重新编号，返回删除的块数
+int removeUnreachable(IRFunction& fn) {
+    vector<int> index(fn.blocks.size(), -1);
+    vector<int> order, work{ 0 };
+    index[0] = 0;
+    while (!work.empty()) {
+        int b = work.back();
+        work.pop_back();
+        order.push_back(b);
+        const IRBlock& blk = fn.blocks[b];
+        int n = blk.term == IR_BRANCH ? 2 : (blk.term == IR_JUMP ? 1 : 0);
+        for (int k = 0; k < n; k++) {
+            if (index[blk.succ[k]] < 0) {
+                index[blk.succ[k]] = 0;
+                work.push_back(blk.succ[k]);
+            }
+        }
+    }
+    if (order.size() == fn.blocks.size()) return 0;
+
+    // 保持原有的相对顺序，使顺序执行的块仍然相邻
+    vector<IRBlock> kept;
+    for (size_t b = 0; b < fn.blocks.size(); b++) {
+        if (index[b] < 0) continue;
+        index[b] = (int)kept.size();
+        kept.push_back(move(fn.blocks[b]));
+    }
+    for (IRBlock& b : kept) {
+        if (b.term != IR_HALT) b.succ[0] = index[b.succ[0]];
+        if (b.term == IR_BRANCH) b.succ[1] = index[b.succ[1]];
+    }
+    int removed = (int)(fn.blocks.size() - kept.size());
+    fn.blocks = move(kept);
+    return removed;
+}
+
+// ---------------------------------------------------------------------------
+// 常量折叠与传播：变量在基本块之间按格 {未定, 常量, 非常量} 做前向数据流分析，
+// 条件可判定的分支只沿成立的一侧传播；临时值只在块内有效，逐条计算即可。
+// 随后把已知为常量的操作数替换为常量，删除结果为常量的临时值运算。
+
+struct Lattice {
+    enum Kind : uint8_t { UNDEF, CONST, NAC } kind = UNDEF;
+    SemValue value;
+    int operand = -1;       // CONST: 已登记到常量池时的操作数，避免重复查找
+
+    bool operator==(const Lattice& o) const {
+        return kind == o.kind && (kind != CONST || (value.type == o.value.type && value.i == o.value.i));
+    }
+    bool operator!=(const Lattice& o) const { return !(*this == o); }
+
+    static Lattice constant(SemValue v) {
+        Lattice x;
+        x.kind = CONST;
+        x.value = v;
+        return x;
+    }
+    static Lattice nac() {
+        Lattice x;
+        x.kind = NAC;
+        return x;
+    }
+};
+
+Lattice meet(const Lattice& a, const Lattice& b) {
+    if (a.kind == Lattice::UNDEF) return b;
+    if (b.kind == Lattice::UNDEF) return a;
+    if (a == b) return a;
+    return Lattice::nac();
+}
+
+class ConstProp {
+public:
+    explicit ConstProp(IRFunction& f) : fn(f), temps(f.tempCount) {}
+
+    int run() {
+        solve();
+        int changes = 0;
+        for (size_t b = 0; b < fn.blocks.size(); b++) {
+            if (reached[b]) changes += rewrite(fn.blocks[b], in[b]);
+        }
+        return changes;
+    }
+
+private:
+    IRFunction& fn;
+    vector<vector<Lattice>> in;
+    vector<bool> reached;
+    vector<Lattice> temps;
+
+    Lattice valueOf(int operand, const vector<Lattice>& vars) const {
+        switch (irKind(operand)) {
+        case IR_CONST: {
+            Lattice x = Lattice::constant(fn.constants[irIndex(operand)]);
+            x.operand = operand;
+            return x;
+        }
+        case IR_VAR: return vars[irIndex(operand)];
+        default: return temps[irIndex(operand)];
+        }
+    }
+
+    Lattice evaluate(const IRInstr& in, const vector<Lattice>& vars) const {
+        Lattice a = valueOf(in.a, vars);
+        Lattice b = isBinary(in.op) ? valueOf(in.b, vars) : Lattice::constant(SemValue());
+        if (a.kind == Lattice::NAC || b.kind == Lattice::NAC) return Lattice::nac();
+        if (a.kind == Lattice::UNDEF || b.kind == Lattice::UNDEF) return Lattice();
+        SemValue out;
+        if (!foldInstr(in.op, a.value, b.value, out)) return Lattice::nac();
+        return Lattice::constant(out);
+    }
+
+    // 块内逐条计算，vars由入口状态变为出口状态
+    void transfer(const IRBlock& b, vector<Lattice>& vars) {
+        for (const IRInstr& in : b.code) {
+            Lattice v = evaluate(in, vars);
+            if (in.op == IR_STORE) vars[irIndex(in.dst)] = v;
+            else temps[irIndex(in.dst)] = v;
+        }
+    }
+
+    // 分支条件已知时返回应走的一侧（0或1），否则返回-1
+    int decide(const IRBlock& b, const vector<Lattice>& vars) const {
+        if (b.term != IR_BRANCH) return -1;
+        Lattice l = valueOf(b.lhs, vars), r = valueOf(b.rhs, vars);
+        if (l.kind != Lattice::CONST || r.kind != Lattice::CONST) return -1;
+        return foldCompare(b.rel, b.realCompare, l.value, r.value) ? 0 : 1;
+    }
+
+    void solve() {
+        size_t n = fn.blocks.size();
+        in.assign(n, vector<Lattice>(fn.varCount));
+        reached.assign(n, false);
+        for (int v = 0; v < fn.varCount; v++) {
+            in[0][v] = v < (int)fn.entryValues.size() ? Lattice::constant(fn.entryValues[v]) : Lattice::nac();
+        }
+        reached[0] = true;
+
+        vector<int> work{ 0 };
+        vector<bool> queued(n, false);
+        queued[0] = true;
+        while (!work.empty()) {
+            int b = work.back();
+            work.pop_back();
+            queued[b] = false;
+
+            const IRBlock& blk = fn.blocks[b];
+            vector<Lattice> out = in[b];
+            transfer(blk, out);
+
+            auto flow = [&](int s) {
+                bool changed = !reached[s];
+                reached[s] = true;
+                for (int v = 0; v < fn.varCount; v++) {
+                    Lattice m = meet(in[s][v], out[v]);
+                    if (m != in[s][v]) {
+                        in[s][v] = m;
+                        changed = true;
+                    }
+                }
+                if (changed && !queued[s]) {
+                    queued[s] = true;
+                    work.push_back(s);
+                }
+            };
+            if (blk.term == IR_JUMP) {
+                flow(blk.succ[0]);
+            } else if (blk.term == IR_BRANCH) {
+                int side = decide(blk, out);
+                if (side != 1) flow(blk.succ[0]);
+                if (side != 0) flow(blk.succ[1]);
+            }
+        }
+    }
+
+    int constOperand(Lattice& v) {
+        if (v.operand < 0) v.operand = fn.addConst(v.value);
+        return v.operand;
+    }
+
+    // 用常量替换操作数，返回替换的次数
+    int substitute(int& operand, vector<Lattice>& vars) {
+        Lattice* v;
+        switch (irKind(operand)) {
+        case IR_VAR: v = &vars[irIndex(operand)]; break;
+        case IR_TEMP: v = &temps[irIndex(operand)]; break;
+        default: return 0;
+        }
+        if (v->kind != Lattice::CONST) return 0;
+        operand = constOperand(*v);
+        return 1;
+    }
+
+    // 结果为常量的临时值运算直接删除：它在块内的所有使用都会被替换为常量
+    int rewrite(IRBlock& b, vector<Lattice> vars) {
+        int changes = 0;
+        size_t k = 0;
+        for (size_t i = 0; i < b.code.size(); i++) {
+            IRInstr in = b.code[i];
+            Lattice v = evaluate(in, vars);
+            if (in.op == IR_STORE) {
+                changes += substitute(in.a, vars);
+                vars[irIndex(in.dst)] = v;
+            } else {
+                temps[irIndex(in.dst)] = v;
+                if (v.kind == Lattice::CONST) {
+                    changes++;
+                    continue;
+                }
+                changes += substitute(in.a, vars);
+                if (isBinary(in.op)) changes += substitute(in.b, vars);
+            }
+            b.code[k++] = in;
+        }
+        b.code.resize(k);
+        if (b.term == IR_BRANCH) {
+            changes += substitute(b.lhs, vars);
+            changes += substitute(b.rhs, vars);
+        }
+        return changes;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// 常量条件分支消除：条件两侧均为常量的分支改为无条件跳转，删除不可达的块，
+// 再把只有唯一前驱的块并入前驱
+
+int branchFold(IRFunction& fn) {
+    int changes = 0;
+    for (IRBlock& b : fn.blocks) {
+        if (b.term != IR_BRANCH) continue;
+        int taken = -1;
+        if (b.succ[0] == b.succ[1]) {
+            taken = b.succ[0];
+        } else if (irKind(b.lhs) == IR_CONST && irKind(b.rhs) == IR_CONST) {
+            bool c = foldCompare(b.rel, b.realCompare, fn.constants[irIndex(b.lhs)], fn.constants[irIndex(b.rhs)]);
+            taken = c ? b.succ[0] : b.succ[1];
+        }
+        if (taken < 0) continue;
+        b.term = IR_JUMP;
+        b.succ[0] = taken;
+        b.succ[1] = -1;
+        changes++;
+    }
+    changes += removeUnreachable(fn);
+
+    vector<int> preds = predecessorCounts(fn);
+    vector<bool> merged(fn.blocks.size(), false);
+    for (size_t a = 0; a < fn.blocks.size(); a++) {
+        if (merged[a]) continue;
+        IRBlock& blk = fn.blocks[a];
+        while (blk.term == IR_JUMP) {
+            int s = blk.succ[0];
+            if (s == 0 || s == (int)a || preds[s] != 1) break;
+            IRBlock& next = fn.blocks[s];
+            blk.code.insert(blk.code.end(), next.code.begin(), next.code.end());
+            blk.term = next.term;
+            blk.rel = next.rel;
+            blk.realCompare = next.realCompare;
+            blk.lhs = next.lhs;
+            blk.rhs = next.rhs;
+            blk.succ[0] = next.succ[0];
+            blk.succ[1] = next.succ[1];
+            // 被并入的块不再有前驱，随后作为不可达块删除
+            next.code.clear();
+            next.term = IR_HALT;
+            merged[s] = true;
+            changes++;
+        }
+    }
+    removeUnreachable(fn);
+    return changes;
+}
+
+// ---------------------------------------------------------------------------
+// 复写传播（块内）：t = copy x 之后用x代替t；v = store x 之后，直到v或x再被赋值前，
+// 用x代替对v的读取
+
+int copyProp(IRFunction& fn) {
+    // 按操作数的种类与下标直接寻址；epoch区分基本块，换块时无需清空
+    struct Entry {
+        int epoch = -1;
+        int to;
+    };
+    vector<Entry> varCopy(fn.varCount), tempCopy(fn.tempCount);
+    vector<vector<int>> dependents(fn.varCount);     // 变量 -> 以它为替代值的操作数
+    vector<int> touched;                             // 本块中dependents非空的变量
+    int epoch = 0;
+    int changes = 0;
+
+    auto slot = [&](int x) -> Entry* {
+        switch (irKind(x)) {
+        case IR_VAR: return &varCopy[irIndex(x)];
+        case IR_TEMP: return &tempCopy[irIndex(x)];
+        default: return nullptr;
+        }
+    };
+    auto substitute = [&](int& x) {
+        Entry* e = slot(x);
+        if (!e || e->epoch != epoch) return;
+        x = e->to;
+        changes++;
+    };
+    auto record = [&](int from, int to) {
+        if (from == to) return;
+        *slot(from) = { epoch, to };
+        if (irKind(to) != IR_VAR) return;
+        vector<int>& d = dependents[irIndex(to)];
+        if (d.empty()) touched.push_back(irIndex(to));
+        d.push_back(from);
+    };
+    // 变量被重新赋值：它自身的替代值与以它为替代值的记录都失效
+    auto kill = [&](int var) {
+        varCopy[irIndex(var)].epoch = -1;
+        vector<int>& d = dependents[irIndex(var)];
+        for (int from : d) {
+            Entry* e = slot(from);
+            if (e->epoch == epoch && e->to == var) e->epoch = -1;
+        }
+        d.clear();
+    };
+
+    for (IRBlock& b : fn.blocks) {
+        epoch++;
+        for (IRInstr& in : b.code) {
+            substitute(in.a);
+            if (isBinary(in.op)) substitute(in.b);
+            if (in.op == IR_COPY) {
+                record(in.dst, in.a);
+            } else if (in.op == IR_STORE) {
+                kill(in.dst);
+                record(in.dst, in.a);
+            }
+        }
+        if (b.term == IR_BRANCH) {
+            substitute(b.lhs);
+            substitute(b.rhs);
+        }
+        // 本块的依赖记录已随epoch失效
+        for (int v : touched) dependents[v].clear();
+        touched.clear();
+    }
+    return changes;
+}
+
+// ---------------------------------------------------------------------------
+// 公共子表达式消除（块内值编号）：同一块内操作符与操作数都相同的运算只计算一次，
+// 其后的重复运算改写为copy；可交换运算先规范操作数顺序。操作数中的变量被赋值后失效。
+
+struct ExprKey {
+    IROp op;
+    int a, b;
+    bool operator==(const ExprKey& o) const { return op == o.op && a == o.a && b == o.b; }
+};
+
+struct ExprKeyHash {
+    size_t operator()(const ExprKey& k) const {
+        size_t h = k.op;
+        h = h * 1000003u ^ (size_t)(unsigned)k.a;
+        h = h * 1000003u ^ (size_t)(unsigned)k.b;
+        return h;
+    }
+};
+
+int commonSubexpressions(IRFunction& fn) {
+    int changes = 0;
+    unordered_map<ExprKey, int, ExprKeyHash> available;
+    unordered_map<int, vector<ExprKey>> users;     // 变量 -> 用到它的表达式
+
+    for (IRBlock& b : fn.blocks) {
+        available.clear();
+        users.clear();
+        for (IRInstr& in : b.code) {
+            if (in.op == IR_STORE) {
+                auto u = users.find(in.dst);
+                if (u == users.end()) continue;
+                for (const ExprKey& k : u->second) available.erase(k);
+                users.erase(u);
+                continue;
+            }
+            if (in.op == IR_COPY) continue;
+
+            ExprKey key{ in.op, in.a, isBinary(in.op) ? in.b : 0 };
+            if (isCommutative(in.op) && key.a > key.b) swap(key.a, key.b);
+            auto it = available.find(key);
+            if (it != available.end()) {
+                in.op = IR_COPY;
+                in.a = it->second;
+                changes++;
+                continue;
+            }
+            available.emplace(key, in.dst);
+            if (irKind(key.a) == IR_VAR) users[key.a].push_back(key);
+            if (isBinary(in.op) && irKind(key.b) == IR_VAR && key.b != key.a) users[key.b].push_back(key);
+        }
+    }
+    return changes;
+}
+
+// ---------------------------------------------------------------------------
+// 死代码删除：结果没有被使用的临时值运算与自我赋值 v = store v。
+// 除数可能为0的除法保留，以免改变是否报错。
+
+int deadCode(IRFunction& fn) {
+    vector<int> uses(fn.tempCount, 0);
+    auto use = [&](int x, int delta) {
+        if (irKind(x) == IR_TEMP) uses[irIndex(x)] += delta;
+    };
+    for (const IRBlock& b : fn.blocks) {
+        for (const IRInstr& in : b.code) {
+            use(in.a, 1);
+            if (isBinary(in.op)) use(in.b, 1);
+        }
+        if (b.term == IR_BRANCH) {
+            use(b.lhs, 1);
+            use(b.rhs, 1);
+        }
+    }
+
+    int changes = 0;
+    for (IRBlock& b : fn.blocks) {
+        // 逆序扫描，被删除的运算释放其操作数后，前面的运算可以在同一遍中删除
+        vector<bool> dead(b.code.size(), false);
+        for (size_t i = b.code.size(); i-- > 0;) {
+            const IRInstr& in = b.code[i];
+            bool unused = in.op == IR_STORE ? in.a == in.dst
+                                            : uses[irIndex(in.dst)] == 0 && removable(fn, in);
+            if (!unused) continue;
+            dead[i] = true;
+            use(in.a, -1);
+            if (isBinary(in.op)) use(in.b, -1);
+            changes++;
+        }
+        size_t k = 0;
+        for (size_t i = 0; i < b.code.size(); i++) {
+            if (!dead[i]) b.code[k++] = b.code[i];
+        }
+        b.code.resize(k);
+    }
+    return changes;
+}
+
+}
+
+IRPassReport optimizeIR(IRFunction& fn) {
+    IRPassReport report;
+    auto run = [&](const char* name, const function<int(IRFunction&)>& pass) {
+        IRPassStats s;
+        s.name = name;
+        s.instrsBefore = fn.instrCount();
+        s.blocksBefore = fn.blocks.size();
+        auto start = chrono::steady_clock::now();
+        s.changes = pass(fn);
+        s.micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        s.instrsAfter = fn.instrCount();
+        s.blocksAfter = fn.blocks.size();
+        report.passes.push_back(s);
+    };
+
+    run("constprop", [](IRFunction& f) { return ConstProp(f).run(); });
+    run("branchfold", branchFold);
+    run("copyprop", copyProp);
+    run("cse", commonSubexpressions);
+    run("copyprop", copyProp);
+    run("dce", deadCode);
+    return report;
+}
+
+void IRPassReport::print(ostream& out) const {
+    out << left << setw(12) << "pass" << right << setw(12) << "time(us)" << setw(10) << "changes"
+        << setw(18) << "instrs" << setw(14) << "blocks" << "\n";
+    double total = 0;
+    for (const IRPassStats& s : passes) {
+        total += s.micros;
+        out << left << setw(12) << s.name << right << fixed << setprecision(1) << setw(12) << s.micros
+            << setw(10) << s.changes
+            << setw(10) << s.instrsBefore << " -> " << setw(4) << s.instrsAfter
+            << setw(6) << s.blocksBefore << " -> " << setw(4) << s.blocksAfter << "\n";
+    }
+    out << left << setw(12) << "total" << right << setw(12) << total << "\n";
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
@@ -0,0 +1,141 @@
+// SemanticProfile.cpp
+#include "SemanticProfile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <map>
+
+using namespace std;
+
+namespace {
+
+const char* kindName(SemStmt::Kind kind) {
+    switch (kind) {
+    case SemStmt::ASSIGN: return "assign";
+    case SemStmt::IF: return "if";
+    case SemStmt::WHILE: return "while";
+    default: return "block";
+    }
+}
+
+double micros(uint64_t nanos) { return nanos / 1000.0; }
+
+void writeString(ostream& out, const string& s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if ((unsigned char)c < 0x20) {
+            static const char hex[] = "0123456789abcdef";
+            out << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+vector<int> semTokenLines(const string& prog) {
+    vector<int> lines;
+    int line = 1;
+    bool inToken = false;
+    for (char c : prog) {
+        if (isspace((unsigned char)c)) {
+            inToken = false;
+            if (c == '\n') line++;
+        } else if (!inToken) {
+            inToken = true;
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+void SemProfile::collectLines() {
+    map<int, SemLineProfile> byLine;
+    for (const SemStmtProfile& s : stmts) {
+        if (s.count == 0) continue;
+        SemLineProfile& l = byLine[s.line];
+        l.line = s.line;
+        l.count += s.count;
+        l.selfNanos += s.selfNanos;
+    }
+    lines.clear();
+    for (const auto& entry : byLine) lines.push_back(entry.second);
+}
+
+vector<int> SemProfile::hotSpots() const {
+    vector<int> order;
+    for (const SemStmtProfile& s : stmts) {
+        if (s.count > 0) order.push_back(s.stmt);
+    }
+    stable_sort(order.begin(), order.end(), [this](int x, int y) {
+        const SemStmtProfile& a = stmts[x];
+        const SemStmtProfile& b = stmts[y];
+        if (a.selfNanos != b.selfNanos) return a.selfNanos > b.selfNanos;
+        return a.count > b.count;
+    });
+    return order;
+}
+
+void SemProfile::printHotSpots(ostream& out, size_t limit) const {
+    vector<int> order = hotSpots();
+    if (order.size() > limit) order.resize(limit);
+    double total = totalNanos > 0 ? (double)totalNanos : 1.0;
+    ios_base::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+
+    out << fixed << setprecision(3);
+    // 表头用ASCII，setw按字节计宽，中文会使各列错位
+    out << "total " << micros(totalNanos) << " us" << endl;
+    out << left << setw(6) << "line" << setw(8) << "kind" << right << setw(12) << "count" << setw(14) << "self(us)"
+        << setw(14) << "total(us)" << setw(8) << "self%" << setw(14) << "taken%" << "  statement" << endl;
+    for (int i : order) {
+        const SemStmtProfile& s = stmts[i];
+        out << left << setw(6) << s.line << setw(8) << kindName(s.kind) << right << setw(12) << s.count
+            << setw(14) << micros(s.selfNanos) << setw(14) << micros(s.totalNanos) << setw(7)
+            << setprecision(1) << 100.0 * s.selfNanos / total << '%';
+        if (s.kind == SemStmt::IF || s.kind == SemStmt::WHILE) {
+            uint64_t n = s.taken + s.notTaken;
+            out << setw(13) << (n ? 100.0 * s.taken / n : 0.0) << '%';
+        } else {
+            out << setw(14) << "-";
+        }
+        out << setprecision(3) << "  " << s.text << endl;
+    }
+
+    out << left << setw(6) << "line" << right << setw(12) << "count" << setw(14) << "self(us)" << endl;
+    for (const SemLineProfile& l : lines) {
+        out << left << setw(6) << l.line << right << setw(12) << l.count << setw(14) << micros(l.selfNanos) << endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void SemProfile::writeJson(ostream& out) const {
+    out << "{\"totalNanos\":" << totalNanos << ",\"statements\":[";
+    bool first = true;
+    for (const SemStmtProfile& s : stmts) {
+        if (s.count == 0) continue;
+        if (!first) out << ',';
+        first = false;
+        out << "{\"stmt\":" << s.stmt << ",\"kind\":\"" << kindName(s.kind) << "\",\"line\":" << s.line
+            << ",\"text\":";
+        writeString(out, s.text);
+        out << ",\"count\":" << s.count << ",\"totalNanos\":" << s.totalNanos << ",\"selfNanos\":" << s.selfNanos;
+        if (s.kind == SemStmt::IF || s.kind == SemStmt::WHILE) {
+            out << ",\"taken\":" << s.taken << ",\"notTaken\":" << s.notTaken;
+        }
+        out << '}';
+    }
+    out << "],\"lines\":[";
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (i) out << ',';
+        out << "{\"line\":" << lines[i].line << ",\"count\":" << lines[i].count << ",\"selfNanos\":"
+            << lines[i].selfNanos << '}';
+    }
+    out << "]}";
+}
@@ -0,0 +1,36 @@
+// SemanticTypeCheck.cpp
+#include "SemanticTypeCheck.h"
+
+using namespace std;
+
+SemTypeInfo checkSemanticTypes(const SemProgram& program, const vector<SemType>& varTypes) {
+    SemTypeInfo info;
+    info.varTypes = varTypes;
+    info.exprTypes.resize(program.exprs.size(), SEM_UNTYPED);
+
+    for (size_t i = 0; i < program.exprs.size(); i++) {
+        const SemExpr& e = program.exprs[i];
+        switch (e.kind) {
+        case SemExpr::NUM:
+            info.exprTypes[i] = e.value.type;
+            break;
+        case SemExpr::VAR:
+            info.exprTypes[i] = varTypes[e.var];
+            break;
+        case SemExpr::BINARY: {
+            SemType l = info.exprTypes[e.lhs], r = info.exprTypes[e.rhs];
+            info.exprTypes[i] = (l == SEM_REAL || r == SEM_REAL) ? SEM_REAL : l;
+            break;
+        }
+        }
+    }
+
+    // 语句同样按后序存放，赋值语句之间的相对顺序即源程序顺序
+    for (const SemStmt& s : program.stmts) {
+        if (s.kind != SemStmt::ASSIGN) continue;
+        if (varTypes[s.var] == SEM_INT && info.exprTypes[s.expr] == SEM_REAL) {
+            info.errors.push_back("realnum can not be translated into int type");
+        }
+    }
+    return info;
+}
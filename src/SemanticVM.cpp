@@ -0,0 +1,264 @@
+// SemanticVM.cpp
+#include "SemanticVM.h"
+
+#include <sstream>
+#include <utility>
+
+using namespace std;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SEM_VM_THREADED 1
+#endif
+
+static_assert((int)OP_STORE == (int)IR_STORE, "SemOpcode must mirror IROp");
+
+SemChunk compileSemanticIR(const IRFunction& fn, bool budgetChecks) {
+    SemChunk chunk;
+    chunk.constants = fn.constants;
+    chunk.varCount = fn.varCount;
+    int constBase = fn.varCount;
+    int tempBase = constBase + (int)fn.constants.size();
+    chunk.frameSize = tempBase + fn.tempCount;
+
+    auto reg = [&](int operand) {
+        switch (irKind(operand)) {
+        case IR_VAR: return irIndex(operand);
+        case IR_CONST: return constBase + irIndex(operand);
+        default: return tempBase + irIndex(operand);
+        }
+    };
+
+    vector<int> blockStart(fn.blocks.size());
+    vector<pair<size_t, int>> fixups;   // {指令位置, 目标块}
+    auto jumpTo = [&](SemOpcode op, int a, int b, int target) {
+        fixups.push_back({ chunk.code.size(), target });
+        chunk.code.push_back({ op, 0, a, b });
+    };
+
+    for (size_t i = 0; i < fn.blocks.size(); i++) {
+        const IRBlock& b = fn.blocks[i];
+        blockStart[i] = (int)chunk.code.size();
+        for (const IRInstr& in : b.code) {
+            chunk.code.push_back({ (SemOpcode)in.op, reg(in.dst), reg(in.a), (in.op >= IR_IADD && in.op <= IR_RDIV) ? reg(in.b) : 0 });
+        }
+        int next = (int)i + 1;
+        // 回跳（目标不在当前块之后）前检查错误并计一步，每轮循环至少经过一次
+        if (b.term != IR_HALT && (b.succ[0] <= (int)i || (b.term == IR_BRANCH && b.succ[1] <= (int)i))) {
+            chunk.code.push_back({ budgetChecks ? OP_BUDGET : OP_LOOP, 0, 0, 0 });
+        }
+        switch (b.term) {
+        case IR_HALT:
+            chunk.code.push_back({ OP_HALT, 0, 0, 0 });
+            break;
+        case IR_JUMP:
+            if (b.succ[0] != next) jumpTo(OP_JUMP, 0, 0, b.succ[0]);
+            break;
+        case IR_BRANCH: {
+            int rel = (int)b.rel + (b.realCompare ? 5 : 0);
+            int l = reg(b.lhs), r = reg(b.rhs);
+            if (b.succ[1] == next) {
+                jumpTo(SemOpcode(OP_BLT_I + rel), l, r, b.succ[0]);
+            } else if (b.succ[0] == next) {
+                jumpTo(SemOpcode(OP_BNLT_I + rel), l, r, b.succ[1]);
+            } else {
+                jumpTo(SemOpcode(OP_BLT_I + rel), l, r, b.succ[0]);
+                jumpTo(OP_JUMP, 0, 0, b.succ[1]);
+            }
+            break;
+        }
+        }
+    }
+    for (const auto& f : fixups) chunk.code[f.first].dst = blockStart[f.second];
+    return chunk;
+}
+
+bool SemanticVM::run(const SemChunk& chunk, SemValue* slots, Mode mode, bool hasError, const ErrorHandler& onError,
+                     SemBudgetMeter* meter) {
+    frame.resize(chunk.frameSize);
+    SemWord* f = frame.data();
+    for (int v = 0; v < chunk.varCount; v++) f[v].i = slots[v].i;
+    for (size_t k = 0; k < chunk.constants.size(); k++) f[chunk.varCount + k].i = chunk.constants[k].i;
+
+    const SemInstr* code = chunk.code.data();
+    const SemInstr* ip = code;
+    const bool precise = mode == PRECISE;
+
+    auto fail = [&](const char* msg) {
+        hasError = true;
+        onError(msg);
+    };
+
+#ifdef SEM_VM_THREADED
+    // 与SemOpcode的顺序一一对应
+    static void* const dispatch[OP_COUNT] = {
+        &&L_OP_COPY, &&L_OP_I2R,
+        &&L_OP_IADD, &&L_OP_ISUB, &&L_OP_IMUL, &&L_OP_IDIV,
+        &&L_OP_RADD, &&L_OP_RSUB, &&L_OP_RMUL, &&L_OP_RDIV,
+        &&L_OP_STORE, &&L_OP_JUMP,
+        &&L_OP_BLT_I, &&L_OP_BGT_I, &&L_OP_BLE_I, &&L_OP_BGE_I, &&L_OP_BEQ_I,
+        &&L_OP_BLT_R, &&L_OP_BGT_R, &&L_OP_BLE_R, &&L_OP_BGE_R, &&L_OP_BEQ_R,
+        &&L_OP_BNLT_I, &&L_OP_BNGT_I, &&L_OP_BNLE_I, &&L_OP_BNGE_I, &&L_OP_BNEQ_I,
+        &&L_OP_BNLT_R, &&L_OP_BNGT_R, &&L_OP_BNLE_R, &&L_OP_BNGE_R, &&L_OP_BNEQ_R,
+        &&L_OP_HALT, &&L_OP_BUDGET, &&L_OP_LOOP
+    };
+#define VM_CASE(name) L_##name
+#define VM_NEXT() goto *dispatch[ip->op]
+    VM_NEXT();
+#else
+#define VM_CASE(name) case name
+#define VM_NEXT() continue
+    for (;;) switch (ip->op) {
+#endif
+
+#define VM_INT_OP(wrap)                                                 \
+    f[ip->dst].i = wrap(f[ip->a].i, f[ip->b].i);                        \
+    ip++;                                                               \
+    VM_NEXT()
+
+#define VM_REAL_OP(op)                                                  \
+    f[ip->dst].r = f[ip->a].r op f[ip->b].r;                            \
+    ip++;                                                               \
+    VM_NEXT()
+
+// 除零：精确模式下报错并保留左值，推测模式下放弃执行
+#define VM_DIV_CHECK(field)                                             \
+    if (f[ip->b].field == 0) {                                          \
+        if (!precise) return false;                                     \
+        fail("division by zero");                                       \
+        f[ip->dst] = f[ip->a];                                          \
+        ip++;                                                           \
+        VM_NEXT();                                                      \
+    }
+
+#define VM_BRANCH(field, cmp)                                           \
+    ip = (f[ip->a].field cmp f[ip->b].field) ? code + ip->dst : ip + 1; \
+    VM_NEXT()
+
+#define VM_BRANCH_NOT(field, cmp)                                       \
+    ip = (f[ip->a].field cmp f[ip->b].field) ? ip + 1 : code + ip->dst; \
+    VM_NEXT()
+
+    VM_CASE(OP_COPY):
+        f[ip->dst] = f[ip->a];
+        ip++;
+        VM_NEXT();
+
+    VM_CASE(OP_I2R):
+        f[ip->dst].r = (double)f[ip->a].i;
+        ip++;
+        VM_NEXT();
+
+    VM_CASE(OP_IADD):
+        VM_INT_OP(semWrapAdd);
+
+    VM_CASE(OP_ISUB):
+        VM_INT_OP(semWrapSub);
+
+    VM_CASE(OP_IMUL):
+        VM_INT_OP(semWrapMul);
+
+    VM_CASE(OP_IDIV):
+        VM_DIV_CHECK(i);
+        VM_INT_OP(semWrapDiv);
+
+    VM_CASE(OP_RADD):
+        VM_REAL_OP(+);
+
+    VM_CASE(OP_RSUB):
+        VM_REAL_OP(-);
+
+    VM_CASE(OP_RMUL):
+        VM_REAL_OP(*);
+
+    VM_CASE(OP_RDIV):
+        VM_DIV_CHECK(r);
+        VM_REAL_OP(/);
+
+    VM_CASE(OP_STORE):
+        if (!hasError) f[ip->dst] = f[ip->a];
+        ip++;
+        VM_NEXT();
+
+    VM_CASE(OP_JUMP):
+        ip = code + ip->dst;
+        VM_NEXT();
+
+    VM_CASE(OP_BLT_I): VM_BRANCH(i, <);
+    VM_CASE(OP_BGT_I): VM_BRANCH(i, >);
+    VM_CASE(OP_BLE_I): VM_BRANCH(i, <=);
+    VM_CASE(OP_BGE_I): VM_BRANCH(i, >=);
+    VM_CASE(OP_BEQ_I): VM_BRANCH(i, ==);
+    VM_CASE(OP_BLT_R): VM_BRANCH(r, <);
+    VM_CASE(OP_BGT_R): VM_BRANCH(r, >);
+    VM_CASE(OP_BLE_R): VM_BRANCH(r, <=);
+    VM_CASE(OP_BGE_R): VM_BRANCH(r, >=);
+    VM_CASE(OP_BEQ_R): VM_BRANCH(r, ==);
+    VM_CASE(OP_BNLT_I): VM_BRANCH_NOT(i, <);
+    VM_CASE(OP_BNGT_I): VM_BRANCH_NOT(i, >);
+    VM_CASE(OP_BNLE_I): VM_BRANCH_NOT(i, <=);
+    VM_CASE(OP_BNGE_I): VM_BRANCH_NOT(i, >=);
+    VM_CASE(OP_BNEQ_I): VM_BRANCH_NOT(i, ==);
+    VM_CASE(OP_BNLT_R): VM_BRANCH_NOT(r, <);
+    VM_CASE(OP_BNGT_R): VM_BRANCH_NOT(r, >);
+    VM_CASE(OP_BNLE_R): VM_BRANCH_NOT(r, <=);
+    VM_CASE(OP_BNGE_R): VM_BRANCH_NOT(r, >=);
+    VM_CASE(OP_BNEQ_R): VM_BRANCH_NOT(r, ==);
+
+    VM_CASE(OP_BUDGET):
+        if (hasError) goto halt;
+        if (!meter->tick()) return false;
+        ip++;
+        VM_NEXT();
+
+    VM_CASE(OP_LOOP):
+        if (hasError) goto halt;
+        ip++;
+        VM_NEXT();
+
+    VM_CASE(OP_HALT):
+    halt:
+        // 只写回8字节的值部分，变量的类型标记不变
+        for (int v = 0; v < chunk.varCount; v++) slots[v].i = f[v].i;
+        return true;
+
+#ifndef SEM_VM_THREADED
+    default:
+        return true;
+    }
+#endif
+
+#undef VM_BRANCH_NOT
+#undef VM_BRANCH
+#undef VM_DIV_CHECK
+#undef VM_REAL_OP
+#undef VM_INT_OP
+#undef VM_NEXT
+#undef VM_CASE
+}
+
+string disassembleSemanticChunk(const SemChunk& chunk) {
+    static const char* const names[OP_COUNT] = {
+        "COPY", "I2R", "IADD", "ISUB", "IMUL", "IDIV", "RADD", "RSUB", "RMUL", "RDIV",
+        "STORE", "JUMP",
+        "BLT_I", "BGT_I", "BLE_I", "BGE_I", "BEQ_I",
+        "BLT_R", "BGT_R", "BLE_R", "BGE_R", "BEQ_R",
+        "BNLT_I", "BNGT_I", "BNLE_I", "BNGE_I", "BNEQ_I",
+        "BNLT_R", "BNGT_R", "BNLE_R", "BNGE_R", "BNEQ_R",
+        "HALT", "BUDGET", "LOOP"
+    };
+    ostringstream out;
+    for (size_t i = 0; i < chunk.code.size(); i++) {
+        const SemInstr& in = chunk.code[i];
+        out << i << "\t" << names[in.op];
+        if (in.op <= OP_STORE) {
+            out << "\tr" << in.dst << ", r" << in.a;
+            if (in.op >= OP_IADD && in.op <= OP_RDIV) out << ", r" << in.b;
+        } else if (in.op == OP_JUMP) {
+            out << "\t" << in.dst;
+        } else if (in.op < OP_HALT) {
+            out << "\tr" << in.a << ", r" << in.b << ", " << in.dst;
+        }
+        out << "\n";
+    }
+    return out.str();
+}
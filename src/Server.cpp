@@ -0,0 +1,386 @@
+// Server.cpp
+#include "Server.h"
+#include "OutputSink.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+// 多生产者多消费者的阻塞队列；close后pop在取完剩余元素后返回false
+template <typename T>
+class BlockingQueue {
+public:
+    void push(T item) {
+        {
+            lock_guard<mutex> lock(m);
+            items.push_back(move(item));
+        }
+        ready.notify_one();
+    }
+
+    bool pop(T& item) {
+        unique_lock<mutex> lock(m);
+        ready.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        item = move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+    void close() {
+        {
+            lock_guard<mutex> lock(m);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+private:
+    mutex m;
+    condition_variable ready;
+    deque<T> items;
+    bool closed = false;
+};
+
+// 固定数目的工作线程，每个线程持有自己的AnalysisSession，任务在其上执行
+class SessionPool {
+public:
+    using Task = function<void(AnalysisSession&)>;
+
+    SessionPool(const DriverOptions& options, const shared_ptr<const SLRTables>& tables, unsigned threads) {
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; i++) {
+            workers.emplace_back([this, &options, tables] {
+                AnalysisSession session(options, tables);
+                Task task;
+                while (tasks.pop(task)) {
+                    // 任务自己报告失败，异常不能结束工作线程
+                    try {
+                        task(session);
+                    } catch (...) {
+                    }
+                }
+            });
+        }
+    }
+
+    ~SessionPool() { join(); }
+
+    void submit(Task task) { tasks.push(move(task)); }
+
+    // 不再接受任务，执行完已提交的任务后返回
+    void join() {
+        tasks.close();
+        for (thread& t : workers) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+private:
+    BlockingQueue<Task> tasks;
+    vector<thread> workers;
+};
+
+void putLength(string& frame, uint32_t n) {
+    for (int shift = 24; shift >= 0; shift -= 8) frame.push_back((char)((n >> shift) & 0xff));
+}
+
+uint32_t getLength(const unsigned char* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+// 标准输入输出上的帧
+bool readFileFrame(FILE* in, string& payload) {
+    unsigned char header[4];
+    if (fread(header, 1, 4, in) != 4) return false;
+    uint32_t n = getLength(header);
+    if (n > SERVER_MAX_FRAME) return false;
+    payload.resize(n);
+    return n == 0 || fread(&payload[0], 1, n, in) == n;
+}
+
+bool writeFileFrame(FILE* out, const string& payload) {
+    string frame;
+    frame.reserve(payload.size() + 4);
+    putLength(frame, (uint32_t)payload.size());
+    frame += payload;
+    return fwrite(frame.data(), 1, frame.size(), out) == frame.size() && fflush(out) == 0;
+}
+
+// 请求可在工作线程上乱序完成，响应仍按请求顺序写出：
+// 读线程为每个请求排入一个future，写线程按顺序等待并写出
+int serveStdio(const DriverOptions& options, const shared_ptr<const SLRTables>& tables) {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    SessionPool pool(options, tables, options.threads);
+    BlockingQueue<future<string>> pending;
+    bool writeFailed = false;
+    thread writer([&] {
+        future<string> response;
+        while (pending.pop(response)) {
+            string payload;
+            try {
+                payload = response.get();
+            } catch (const exception& e) {
+                payload = string(1, (char)SERVER_ERRORS) + "分析过程中出现错误: " + e.what();
+            }
+            if (!writeFailed && !writeFileFrame(stdout, payload)) writeFailed = true;
+        }
+    });
+
+    string request;
+    while (readFileFrame(stdin, request)) {
+        auto result = make_shared<promise<string>>();
+        pending.push(result->get_future());
+        pool.submit([result, request](AnalysisSession& session) {
+            try {
+                result->set_value(handleServerRequest(session, request));
+            } catch (...) {
+                result->set_exception(current_exception());
+            }
+        });
+    }
+    pool.join();
+    pending.close();
+    writer.join();
+    return writeFailed ? 1 : 0;
+}
+
+} // namespace
+
+string makeServerRequest(DriverMode mode, DriverFormat format, const string& code) {
+    string request;
+    request.reserve(code.size() + 2);
+    request.push_back((char)mode);
+    request.push_back(format == FORMAT_SUMMARY ? 1 : format == FORMAT_NDJSON ? 2 : 0);
+    request += code;
+    return request;
+}
+
+string handleServerRequest(AnalysisSession& session, const string& request) {
+    int mode = request.empty() ? 0 : (unsigned char)request[0];
+    if (request.size() < 2 || mode < DRIVER_LEX || mode > DRIVER_SEM) {
+        return string(1, (char)SERVER_BAD_REQUEST) + "无效的请求";
+    }
+    bool summary = (request[1] & 1) != 0;
+    DriverFormat format = summary ? FORMAT_SUMMARY : (request[1] & 2) ? FORMAT_NDJSON : FORMAT_TEXT;
+
+    // 请求之间互不影响：处理中的异常（如内存不足）只使本请求以错误状态返回，不终止工作线程
+    try {
+        string code = request.substr(2);
+
+        // 响应的状态字节先占位，分析输出直接写在其后
+        OutputSink sink;
+        sink << '\0';
+        ostream out(&sink);
+        string detail;
+        bool ok = session.process((DriverMode)mode, code, format, out, detail);
+        if (summary) sink << detail;
+        string response = sink.take();
+        response[0] = (char)(ok ? SERVER_OK : SERVER_ERRORS);
+        return response;
+    } catch (const exception& e) {
+        return string(1, (char)SERVER_ERRORS) + "分析过程中出现错误: " + e.what();
+    } catch (...) {
+        return string(1, (char)SERVER_ERRORS) + "分析过程中出现错误";
+    }
+}
+
+#ifndef _WIN32
+
+namespace {
+
+bool readExact(int fd, char* p, size_t n) {
+    while (n > 0) {
+        ssize_t got = ::read(fd, p, n);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        p += got;
+        n -= (size_t)got;
+    }
+    return true;
+}
+
+bool writeExact(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t put = ::write(fd, p, n);
+        if (put < 0 && errno == EINTR) continue;
+        if (put <= 0) return false;
+        p += put;
+        n -= (size_t)put;
+    }
+    return true;
+}
+
+// 信号处理函数中只做异步信号安全的shutdown，accept随即失败，serve返回
+volatile sig_atomic_t signalListenFd = -1;
+
+void onStopSignal(int) {
+    if (signalListenFd >= 0) shutdown(signalListenFd, SHUT_RDWR);
+}
+
+} // namespace
+
+bool readServerFrame(int fd, string& payload) {
+    unsigned char header[4];
+    if (!readExact(fd, (char*)header, 4)) return false;
+    uint32_t n = getLength(header);
+    if (n > SERVER_MAX_FRAME) return false;
+    payload.resize(n);
+    return n == 0 || readExact(fd, &payload[0], n);
+}
+
+bool writeServerFrame(int fd, const string& payload) {
+    if (payload.size() > SERVER_MAX_FRAME) return false;
+    // 长度与内容一次写出，避免小包分两次发送
+    string frame;
+    frame.reserve(payload.size() + 4);
+    putLength(frame, (uint32_t)payload.size());
+    frame += payload;
+    return writeExact(fd, frame.data(), frame.size());
+}
+
+AnalysisServer::AnalysisServer(const DriverOptions& o, unsigned threads)
+    : options(o), threadCount(threads),
+      tables(options.tableCache.empty() ? SLRTables::shared() : SLRTables::create(options.tableCache)) {}
+
+AnalysisServer::~AnalysisServer() {
+    stop();
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+}
+
+bool AnalysisServer::listen(const string& path, string& failure) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        failure = "套接字路径为空或过长";
+        return false;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        failure = string("无法创建套接字: ") + strerror(errno);
+        return false;
+    }
+    unlink(path.c_str());
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, 128) < 0) {
+        failure = "无法监听 " + path + ": " + strerror(errno);
+        close(fd);
+        return false;
+    }
+    listenFd = fd;
+    socketPath = path;
+    return true;
+}
+
+void AnalysisServer::serve() {
+    SessionPool pool(options, tables, threadCount);
+    while (!stopping) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        pool.submit([this, fd](AnalysisSession& session) { serveConnection(session, fd); });
+    }
+    // 监听套接字失效（stop或信号）后断开现有连接，等工作线程退出
+    stop();
+    pool.join();
+}
+
+void AnalysisServer::stop() {
+    stopping = true;
+    lock_guard<mutex> lock(connectionsMutex);
+    if (listenFd >= 0) shutdown(listenFd, SHUT_RDWR);
+    for (int fd : connections) shutdown(fd, SHUT_RDWR);
+}
+
+void AnalysisServer::serveConnection(AnalysisSession& session, int fd) {
+    {
+        lock_guard<mutex> lock(connectionsMutex);
+        if (stopping) {
+            close(fd);
+            return;
+        }
+        connections.insert(fd);
+    }
+    // 读帧时内存不足等异常只断开本连接，连接照常注销并关闭
+    try {
+        string request;
+        while (readServerFrame(fd, request)) {
+            if (!writeServerFrame(fd, handleServerRequest(session, request))) break;
+        }
+    } catch (...) {
+    }
+    {
+        lock_guard<mutex> lock(connectionsMutex);
+        connections.erase(fd);
+    }
+    close(fd);
+}
+
+#endif
+
+int runServer(const DriverOptions& options) {
+#ifndef _WIN32
+    // 对端提前关闭时写入返回错误，而不是以SIGPIPE终止进程
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    if (options.serveStdio) {
+        shared_ptr<const SLRTables> tables =
+            options.tableCache.empty() ? SLRTables::shared() : SLRTables::create(options.tableCache);
+        return serveStdio(options, tables);
+    }
+
+#ifdef _WIN32
+    cerr << "此平台不支持Unix域套接字，请使用--serve-stdio" << endl;
+    return 2;
+#else
+    AnalysisServer server(options, options.threads);
+    string failure;
+    if (!server.listen(options.serveSocket, failure)) {
+        cerr << failure << endl;
+        return 2;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    signalListenFd = server.listeningFd();
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    server.serve();
+    signalListenFd = -1;
+    return 0;
+#endif
+}
@@ -0,0 +1,52 @@
+// SymbolTable.cpp
+#include "SymbolTable.h"
+
+#include <charconv>
+#include <stdexcept>
+
+using namespace std;
+
+const char* semTypeName(SemType type) {
+    switch (type) {
+    case SEM_INT: return "int";
+    case SEM_REAL: return "real";
+    default: return "";
+    }
+}
+
+bool semParseInt(const string& text, int64_t& value) {
+    value = 0;
+    return from_chars(text.data(), text.data() + text.size(), value).ec != errc::result_out_of_range;
+}
+
+int SymbolTable::declare(const string& name, SemType type) {
+    int slot = lookup(name);
+    if (slot < 0) slot = declareUntyped(name);
+    vars[slot].type = type;
+    return slot;
+}
+
+int SymbolTable::declareUntyped(const string& name) {
+    int slot = (int)vars.size();
+    slots.emplace(name, slot);
+    names.push_back(name);
+    vars.emplace_back();
+    return slot;
+}
+
+int SymbolTable::lookup(const string& name) const {
+    auto it = slots.find(name);
+    return it == slots.end() ? -1 : it->second;
+}
+
+const Var& SymbolTable::at(const string& name) const {
+    int slot = lookup(name);
+    if (slot < 0) throw out_of_range("SymbolTable::at: " + name);
+    return vars[slot];
+}
+
+void SymbolTable::clear() {
+    slots.clear();
+    names.clear();
+    vars.clear();
+}
@@ -3,31 +3,50 @@
 
 #include <string>
 #include <iostream>
+#include "Driver.h"
+#include "Server.h"
 #include "utils.h"
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
     // 设置编码
     setConsoleEncoding();
+
+    // 带参数时按命令行处理全部输入，不再交互
+    if (argc > 1) {
+        DriverOptions options;
+        string failure;
+        if (!parseDriverArgs(argc, argv, options, failure)) {
+            cerr << failure << endl;
+            printDriverUsage(cerr);
+            return 2;
+        }
+        if (options.help) {
+            printDriverUsage(cout);
+            return 0;
+        }
+        return options.serving() ? runServer(options) : runDriver(options);
+    }
     
-    // 功能选择以及获取输入。
+    // 功能选择以及获取输入。标准输入不是终端（如由脚本经管道输入）时不输出提示
+    bool prompt = stdinIsTerminal();
     string code;
 
     int mode;
     bool file_flag=true;
     string file_path;
-    cout<<"选择实现功能"<<endl;
+    if(prompt) cout<<"选择实现功能"<<endl;
     cin>>mode;
 
     getchar();
-    cout<<"终端输入(y)or文件输入(default)"<<endl;
+    if(prompt) cout<<"终端输入(y)or文件输入(default)"<<endl;
     if(getchar()=='y')
         file_flag=false;
     getchar();
 
     if(file_flag){
-        cout<<"输入测试文件路径"<<endl;
+        if(prompt) cout<<"输入测试文件路径"<<endl;
         cin>>file_path;
         readCodeFromFile(file_path,code);
     }
@@ -2,6 +2,10 @@
 
 #ifdef _WIN32
 #include <windows.h>
+#include <io.h>
+#include <cstdio>
+#else
+#include <unistd.h>
 #endif
 
 #include<iostream>
@@ -22,9 +26,17 @@ void setConsoleEncoding() {
 #endif
 }
 
+bool stdinIsTerminal() {
+#ifdef _WIN32
+    return _isatty(_fileno(stdin)) != 0;
+#else
+    return isatty(STDIN_FILENO) != 0;
+#endif
+}
+
 // 从标准输入读取代码
 void readCodeFromInput(string& prog) {
-    cout << "输入C代码 (Ctrl+Z结束):" << endl;
+    if (stdinIsTerminal()) cout << "输入C代码 (Ctrl+Z结束):" << endl;
     char c;
     while (cin.get(c)) {
         prog += c;
@@ -34,18 +46,22 @@ void readCodeFromInput(string& prog) {
 
 void readCodeFromFile(std::string file_path,std::string& prog){
 
-    std::ifstream file(file_path);
     cout<<file_path<<endl;
-    if (!file.is_open()) {
+    if (!loadCodeFile(file_path, prog)) {
         std::cerr << "无法打开文件" << std::endl;
         prog="";
     }
-    
-    // 方法A：使用rdbuf()快速读取整个文件
+}
+
+bool loadCodeFile(const std::string& file_path, std::string& prog) {
+    std::ifstream file(file_path);
+    if (!file.is_open()) return false;
+
     std::string line;
     while (std::getline(file, line)) {
         prog += line + "\n";  // 保留换行符
     }
+    return true;
 }
 
 void LexicalFunction(string code){
@@ -54,15 +70,10 @@ void LexicalFunction(string code){
     istringstream iss(code);
     
     // 执行分析
-    int tokenCount = analyzer.analyze(iss);
-    auto tokens = analyzer.getTokens();
+    analyzer.analyze(iss);
     
     // 输出结果
-    cout << "\n分析结果 (" << tokenCount << "个词法单元):" << endl;
-    for (int i = 0; i < tokenCount; ++i) {
-        cout << i+1 << ": <" << tokens[i].key << ", " << tokens[i].value << ">" << endl;
-    }
-    
+    analyzer.printTokens(cout);
 }
 void LL1Function(std::string code){
     Parser parser;
@@ -0,0 +1,46 @@
+// tools/semc.cpp
+// 把语义分析语言的程序编译为x86-64汇编，再用系统工具链生成独立程序：
+//   semc prog.txt prog.s && cc prog.s -o prog
+#include "Semantic.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        cerr << "用法: semc <程序文件|-> <输出.s>" << endl;
+        return 1;
+    }
+
+    // "-"表示从标准输入读取
+    ostringstream prog;
+    if (string(argv[1]) == "-") {
+        prog << cin.rdbuf();
+    } else {
+        ifstream in(argv[1], ios::binary);
+        if (!in) {
+            cerr << "无法打开文件 " << argv[1] << endl;
+            return 1;
+        }
+        prog << in.rdbuf();
+    }
+
+    SemanticAnalyzer analyzer;
+    ostringstream code;
+    string failure;
+    if (!analyzer.compileToAssembly(prog.str(), code, failure)) {
+        cerr << "无法生成代码: " << failure << endl;
+        return 1;
+    }
+
+    ofstream out(argv[2], ios::binary | ios::trunc);
+    if (!out) {
+        cerr << "无法写入 " << argv[2] << endl;
+        return 1;
+    }
+    out << code.str();
+    return out ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+// tools/slr_codegen.cpp
+// 构建时工具：根据SLR分析表生成直接编码的分析器源码
+#include "LRParser.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        cerr << "用法: slr_codegen <输出文件>" << endl;
+        return 1;
+    }
+
+    ostringstream code;
+    SLRTables::create()->generateDirectCode(code);
+
+    // 内容未变时不改写文件，避免触发不必要的重新编译
+    ifstream existing(argv[1], ios::binary);
+    if (existing) {
+        ostringstream old;
+        old << existing.rdbuf();
+        if (old.str() == code.str()) return 0;
+    }
+
+    ofstream out(argv[1], ios::binary | ios::trunc);
+    if (!out) {
+        cerr << "无法写入 " << argv[1] << endl;
+        return 1;
+    }
+    out << code.str();
+    return out ? 0 : 1;
+}